@@ -44,7 +44,17 @@ PERFKIT_CATEGORY(argparse0)
     PERFKIT_CONFIGURE(somestr3, "polo").transient().flags("vRuka").confirm();
 }
 
+PERFKIT_CATEGORY(argparse1)
+{
+    PERFKIT_CONFIGURE(verbose, true).transient().flags("verbose").confirm();
+    PERFKIT_CONFIGURE(count, 0).transient().flags("count", "c").confirm();
+    PERFKIT_CONFIGURE(ratio, 0.).transient().flags("ratio").confirm();
+    PERFKIT_CONFIGURE(items, std::vector<int>{}).transient().flags("items").confirm();
+    PERFKIT_CONFIGURE(names, std::vector<std::string>{}).transient().flags("names").confirm();
+}
+
 static std::vector<std::string> argset0{
+        "exec",
         "--opt0",
         "-NV23",
         "pos1",
@@ -72,14 +82,14 @@ TEST_SUITE("Argument Parser")
         int argc = charpp.size();
         auto argv = charpp.data();
 
-        // TODO: Re-enable this!
         perfkit::v2::configs_parse_args(argc, (const char**&)argv);
         argparse0::registry().update();
 
-        CHECK(argc == 3);
-        CHECK(argv[0] == "pos1"s);
-        CHECK(argv[1] == "pos2"s);
-        CHECK(argv[2] == "pos3"s);
+        CHECK(argc == 4);
+        CHECK(argv[0] == "exec"s);
+        CHECK(argv[1] == "pos1"s);
+        CHECK(argv[2] == "pos2"s);
+        CHECK(argv[3] == "pos3"s);
 
         CHECK(*argparse0::opt0 == true);
         CHECK(*argparse0::opt1 == true);
@@ -96,6 +106,7 @@ TEST_SUITE("Argument Parser")
     TEST_CASE("On Invalid Single Flag")
     {
         std::vector<std::string> argset{
+                "exec",
                 "--opt0",
                 "-NV23S",
                 "pos1",
@@ -111,4 +122,122 @@ TEST_SUITE("Argument Parser")
 
         REQUIRE_THROWS(perfkit::v2::configs_parse_args(argc, (const char**&)argv));
     }
+
+    TEST_CASE("Long Flags and Arrays")
+    {
+        std::vector<std::string> argset{
+                "exec",
+                "--no-verbose",
+                "--count",
+                "42",
+                "pos1",
+                "--ratio=0.5",
+                "--items=1,2,3",
+                "--names",
+                "a,b",
+                "--",
+                "--count=1",
+        };
+
+        auto charpp = to_charpp(argset);
+        int argc = charpp.size();
+        auto argv = charpp.data();
+
+        perfkit::v2::configs_parse_args(argc, (const char**&)argv);
+        argparse1::registry().update();
+
+        REQUIRE(argc == 3);
+        CHECK(argv[0] == "exec"s);
+        CHECK(argv[1] == "pos1"s);
+        CHECK(argv[2] == "--count=1"s);
+
+        CHECK(*argparse1::verbose == false);
+        CHECK(*argparse1::count == 42);
+        CHECK(*argparse1::ratio == 0.5);
+        CHECK(*argparse1::items == std::vector<int>{1, 2, 3});
+        CHECK(*argparse1::names == std::vector<std::string>{"a", "b"});
+    }
+
+    TEST_CASE("Flags Are Kept Unless Consumed")
+    {
+        std::vector<std::string> argset{"exec", "-c7", "pos1"};
+
+        auto charpp = to_charpp(argset);
+        int argc = charpp.size();
+        auto argv = charpp.data();
+
+        perfkit::v2::config_parse_arg_option option;
+        option.consume_flags = false;
+
+        perfkit::v2::configs_parse_args(argc, (const char**&)argv, option);
+        argparse1::registry().update();
+
+        REQUIRE(argc == 3);
+        CHECK(argv[0] == "exec"s);
+        CHECK(argv[1] == "-c7"s);
+        CHECK(argv[2] == "pos1"s);
+        CHECK(*argparse1::count == 7);
+    }
+
+    TEST_CASE("Help and Rejected Values")
+    {
+        auto fn_parse = [](std::vector<std::string> argset) {
+            auto charpp = to_charpp(argset);
+            int argc = charpp.size();
+            auto argv = charpp.data();
+
+            perfkit::v2::configs_parse_args(argc, (const char**&)argv);
+        };
+
+        CHECK_THROWS_AS(fn_parse({"exec", "--help"}), perfkit::v2::configs_parse_help_exception);
+        CHECK_THROWS_AS(fn_parse({"exec", "-h"}), perfkit::v2::configs_parse_help_exception);
+
+        CHECK_THROWS_AS(fn_parse({"exec", "--count=abc"}), std::runtime_error);
+        CHECK_THROWS_AS(fn_parse({"exec", "--items=1,x"}), std::runtime_error);
+        CHECK_THROWS_AS(fn_parse({"exec", "--no-count"}), std::runtime_error);
+        CHECK_THROWS_AS(fn_parse({"exec", "--count"}), std::runtime_error);
+
+        // Rejection message names the flag and the value as given.
+        auto fn_error = [&](std::vector<std::string> argset) -> std::string {
+            try {
+                fn_parse(std::move(argset));
+            } catch (std::runtime_error& e) {
+                return e.what();
+            }
+            return "";
+        };
+
+        auto message = fn_error({"exec", "-c", "abc"});
+        CHECK(message.find("'-c'") != std::string::npos);
+        CHECK(message.find("'abc'") != std::string::npos);
+
+        message = fn_error({"exec", "--count", "--verbose"});
+        CHECK(message.find("'--count'") != std::string::npos);
+        CHECK(message.find("'--verbose'") != std::string::npos);
+    }
+
+    TEST_CASE("Bound Help Flags")
+    {
+        using namespace perfkit::v2;
+        auto rg = config_registry::_internal_create("argparse-help");
+
+        config<bool> conf_h{config_attribute_factory<bool>{"conf_h"}._internal_default_value(false).flags("h").confirm()};
+        config<int> conf_help{config_attribute_factory<int>{"conf_help"}._internal_default_value(0).flags("help").confirm()};
+        conf_h.activate(rg);
+        conf_help.activate(rg);
+        rg->update();
+
+        std::vector<std::string> argset{"exec", "-h", "--help=3"};
+        auto charpp = to_charpp(argset);
+        int argc = charpp.size();
+        auto argv = charpp.data();
+
+        std::vector<config_registry_ptr> regs{rg};
+        configs_parse_args(argc, (const char**&)argv, {}, regs);
+        rg->update();
+
+        CHECK(argc == 1);
+        CHECK(conf_h.value() == true);
+        CHECK(conf_help.value() == 3);
+    }
 }
@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+
+#include "doctest/doctest.h"
+#include "perfkit/configs.h"
+#include "perfkit/detail/configs-v2-backend.hpp"
+
+PERFKIT_CATEGORY(history0)
+{
+    PERFKIT_CONFIGURE(ival, 0).transient().confirm();
+}
+
+static auto fetch_history(perfkit::v2::config_registry& reg)
+{
+    std::vector<perfkit::v2::config_history_entry> entries;
+    reg.backend()->bk_history(&entries);
+    return entries;
+}
+
+TEST_SUITE("Config History")
+{
+    TEST_CASE("Ring, Capacity and Rollback")
+    {
+        auto& reg = history0::registry();
+        auto bk = reg.backend();
+
+        reg.update();
+        bk->bk_history_capacity(3);
+
+        // fences[i] is the fence on which ival became i + 1
+        std::vector<size_t> fences;
+        for (int i = 1; i <= 5; ++i) {
+            history0::ival.commit(i);
+            reg.update();
+            fences.push_back(reg.fence());
+        }
+
+        // Ring keeps the newest 3 changes, oldest first.
+        auto entries = fetch_history(reg);
+        REQUIRE(entries.size() == 3);
+        CHECK(entries[0].fence == fences[2]);
+        CHECK(entries[1].fence == fences[3]);
+        CHECK(entries[2].fence == fences[4]);
+        CHECK(entries[2].key == history0::ival.base()->full_key());
+
+        // Value at fences[0] was overwritten at fences[1], which is dropped from ring.
+        CHECK_FALSE(bk->bk_rollback(fences[0]));
+
+        // Shrinking wrapped ring keeps the newest ones in order.
+        bk->bk_history_capacity(2);
+        entries = fetch_history(reg);
+        REQUIRE(entries.size() == 2);
+        CHECK(entries[0].fence == fences[3]);
+        CHECK(entries[1].fence == fences[4]);
+
+        CHECK_FALSE(bk->bk_rollback(fences[1]));
+        REQUIRE(bk->bk_rollback(fences[2]));
+        reg.update();
+        CHECK(history0::ival.value() == 3);
+
+        // Rollback itself is recorded as a change.
+        entries = fetch_history(reg);
+        REQUIRE(entries.size() == 2);
+        CHECK(entries[1].fence == reg.fence());
+        CHECK(entries[1].source == "rollback");
+
+        // Zero capacity disables recording.
+        bk->bk_history_capacity(0);
+        history0::ival.commit(10);
+        reg.update();
+        CHECK(fetch_history(reg).empty());
+    }
+}
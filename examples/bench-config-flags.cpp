@@ -0,0 +1,81 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <vector>
+
+#include "bench.hpp"
+#include "perfkit/detail/configs-v2-flags.hpp"
+
+using namespace perfkit_bench;
+
+/**
+ * Parse command line of thousands of flags, bound to configs of a single registry.
+ */
+PERFKIT_BENCH_CASE(config_parse_args)
+{
+    using namespace perfkit::v2;
+
+    for (size_t count : {1'000, 10'000}) {
+        auto rg = config_registry::_internal_create("bench.flags." + std::to_string(count));
+        std::vector<config<int>> ints;
+        std::vector<config<bool>> bools;
+
+        // Every bound flag is given on command line, half of them as '--flag=value' form.
+        std::vector<std::string> args{"exec"};
+
+        for (size_t i = 0; i < count; ++i) {
+            auto name = "flag-" + std::to_string(i);
+
+            if (i % 2) {
+                auto attrib = config_attribute_factory<int>{name}._internal_default_value(0).flags(name).confirm();
+                ints.emplace_back(std::move(attrib)).activate(rg);
+                args.push_back("--" + name + "=" + std::to_string(i));
+            } else {
+                auto attrib = config_attribute_factory<bool>{name}._internal_default_value(false).flags(name).confirm();
+                bools.emplace_back(std::move(attrib)).activate(rg);
+                args.push_back("--" + name);
+            }
+
+            args.push_back("positional");
+        }
+
+        rg->update();
+
+        std::vector<char const*> argv_buf;
+        for (auto& arg : args) { argv_buf.push_back(arg.c_str()); }
+
+        int argc = int(argv_buf.size());
+        auto argv = argv_buf.data();
+
+        std::vector<config_registry_ptr> regs{rg};
+        auto elapsed_parse = measure_ms([&] { configs_parse_args(argc, argv, {}, regs); });
+        auto elapsed_update = measure_ms([&] { rg->update(); });
+
+        report(std::to_string(count) + " flags: parse", count, elapsed_parse);
+        report(std::to_string(count) + " flags: apply on update()", count, elapsed_update);
+        printf("  (%d arguments left)\n", argc);
+
+        rg->unregister();
+    }
+}
@@ -0,0 +1,76 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace perfkit_bench;
+
+/**
+ * Hundreds of registries are created and registered from multiple threads at once, as
+ *  config sets of independent modules do on application startup.
+ */
+PERFKIT_BENCH_CASE(config_parallel_startup)
+{
+    using namespace perfkit::v2;
+
+    size_t const num_registries = 800;
+    size_t const num_configs = 20;
+    auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned num_threads = 1, round = 0; num_threads <= max_threads; num_threads *= 2, ++round) {
+        std::vector<config_registry_ptr> registries(num_registries);
+        std::vector<std::vector<config<int>>> configs(num_registries);
+        std::vector<std::thread> workers;
+
+        auto elapsed = measure_ms([&] {
+            for (unsigned th = 0; th < num_threads; ++th) {
+                workers.emplace_back([&, th] {
+                    for (size_t i = th; i < num_registries; i += num_threads) {
+                        auto name = "bench.parallel." + std::to_string(round) + "." + std::to_string(i);
+                        auto& rg = registries[i] = config_registry::_internal_create(name);
+
+                        for (size_t k = 0; k < num_configs; ++k) {
+                            configs[i].push_back(make_config<int>("value" + std::to_string(k), int(k)));
+                            configs[i].back().activate(rg);
+                        }
+
+                        rg->update();
+                    }
+                });
+            }
+
+            for (auto& worker : workers) { worker.join(); }
+        });
+
+        char buf[64];
+        snprintf(buf, sizeof buf, "create + register, %u threads", num_threads);
+        report(buf, num_registries, elapsed);
+
+        for (auto& rg : registries) { rg->unregister(); }
+    }
+}
@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace perfkit_bench;
+
+template <typename ValueType, typename Fn>
+static void read_scaling(char const* label, perfkit::v2::config<ValueType> const& conf, Fn&& fn_touch)
+{
+    size_t const num_reads = 1'000'000;
+    auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        std::atomic_size_t checksum = 0;
+        std::vector<std::thread> readers;
+
+        auto elapsed = measure_ms([&] {
+            for (unsigned i = 0; i < num_threads; ++i) {
+                readers.emplace_back([&] {
+                    size_t local = 0;
+                    for (size_t n = 0; n < num_reads; ++n) { local += fn_touch(conf.value()); }
+                    checksum.fetch_add(local, std::memory_order_relaxed);
+                });
+            }
+
+            for (auto& th : readers) { th.join(); }
+        });
+
+        // Near-linear scaling keeps ns/item shrinking in proportion to thread count.
+        char buf[64];
+        snprintf(buf, sizeof buf, "%s, %u threads", label, num_threads);
+        report(buf, num_reads * num_threads, elapsed);
+    }
+}
+
+/**
+ * Every reader thread reads same config repeatedly, while a writer keeps committing to it.
+ */
+PERFKIT_BENCH_CASE(config_read_scaling)
+{
+    using namespace perfkit::v2;
+    auto rg = config_registry::_internal_create("bench.config-read");
+    rg->set_transient();
+
+    auto scalar = make_config<int64_t>("scalar", 0);
+    auto block = make_config<std::array<int64_t, 4>>("block", {});
+    auto text = make_config<std::string>("text", "some text value");
+
+    scalar.activate(rg);
+    block.activate(rg);
+    text.activate(rg);
+    rg->update();
+
+    std::atomic_bool stop = false;
+    std::thread writer{[&] {
+        for (int64_t i = 0; not stop.load(std::memory_order_relaxed); ++i) {
+            scalar.commit(i);
+            block.commit({i, i, i, i});
+            rg->update();
+            std::this_thread::yield();
+        }
+    }};
+
+    read_scaling("int64 (atomic)", scalar, [](int64_t v) { return size_t(v); });
+    read_scaling("int64[4] (seqlock)", block, [](auto const& v) { return size_t(v[0] ^ v[3]); });
+    read_scaling("string (shared lock)", text, [](auto const& v) { return v.size(); });
+
+    stop = true;
+    writer.join();
+}
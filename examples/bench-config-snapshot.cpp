@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "bench.hpp"
+
+using namespace perfkit_bench;
+
+static std::string snapshot_key(size_t index)
+{
+    return "section" + std::to_string(index % 100) + "|value" + std::to_string(index);
+}
+
+/**
+ * Cold start from config file of 10k, 100k and 1M entries, in json and binary snapshot
+ *  format. A registry of 1000 configs is loaded from the imported file on first update().
+ */
+PERFKIT_BENCH_CASE(config_snapshot_load)
+{
+    using namespace perfkit::v2;
+    namespace fs = std::filesystem;
+
+    auto dir = fs::temp_directory_path();
+    size_t const num_alive = 1000;
+
+    for (size_t count : {10'000, 100'000, 1'000'000}) {
+        auto const name = "bench.snapshot." + std::to_string(count);
+        auto json_path = (dir / (name + ".json")).string();
+        auto binary_path = (dir / (name + ".pkcfg")).string();
+
+        {
+            nlohmann::json content;
+            auto& section = content[name];
+
+            for (size_t i = 0; i < count; ++i) {
+                section[snapshot_key(i)] = (i % 2) ? nlohmann::json(double(i) * 0.5)
+                                                   : nlohmann::json("string value " + std::to_string(i));
+            }
+
+            std::ofstream{json_path} << content.dump(2);
+        }
+
+        auto elapsed_convert = measure_ms([&] { configs_convert(json_path, binary_path); });
+        report("convert json -> binary", count, elapsed_convert);
+
+        auto fn_load = [&](char const* label, std::string const& path, bool use_mmap) {
+            auto rg = config_registry::_internal_create(name);
+
+            std::vector<config<double>> doubles;
+            std::vector<config<std::string>> strs;
+
+            for (size_t i = 0; i < num_alive; ++i) {
+                auto index = i * (count / num_alive);
+                if (index % 2) {
+                    doubles.push_back(make_config<double>(snapshot_key(index), 0.)), doubles.back().activate(rg);
+                } else {
+                    strs.push_back(make_config<std::string>(snapshot_key(index), "")), strs.back().activate(rg);
+                }
+            }
+
+            auto elapsed_import = measure_ms([&] { configs_import(path, use_mmap); });
+            auto elapsed_update = measure_ms([&] { rg->update(); });
+
+            report(std::string{label} + ": import", count, elapsed_import);
+            report(std::string{label} + ": load alive configs", num_alive, elapsed_update);
+            rg->unregister();
+        };
+
+        fn_load("json", json_path, false);
+        fn_load("binary", binary_path, false);
+        fn_load("binary (mmap)", binary_path, true);
+
+        std::error_code ec;
+        fs::remove(json_path, ec);
+        fs::remove(binary_path, ec);
+    }
+}
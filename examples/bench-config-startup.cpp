@@ -0,0 +1,105 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "bench.hpp"
+
+using namespace perfkit_bench;
+
+namespace {
+struct startup_configs {
+    std::vector<perfkit::v2::config<int64_t>> ints;
+    std::vector<perfkit::v2::config<std::string>> strs;
+    std::vector<perfkit::v2::config<std::vector<double>>> arrays;
+
+    explicit startup_configs(perfkit::v2::config_registry_ptr const& rg, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            auto key = "section" + std::to_string(i % 100) + "|value" + std::to_string(i);
+
+            switch (i % 3) {
+                case 0: ints.push_back(make_config<int64_t>(key, 0)), ints.back().activate(rg); break;
+                case 1: strs.push_back(make_config<std::string>(key, "")), strs.back().activate(rg); break;
+                case 2: arrays.push_back(make_config<std::vector<double>>(key, {})), arrays.back().activate(rg); break;
+            }
+        }
+    }
+};
+}  // namespace
+
+/**
+ * Startup of an application with tens of thousands of configs: configs are registered, then
+ *  their values are loaded from previously imported content on first update().
+ */
+PERFKIT_BENCH_CASE(config_startup_import)
+{
+    using namespace perfkit::v2;
+
+    for (size_t count : {4000, 40000}) {
+        auto const name = "bench.startup." + std::to_string(count);
+        global_config_storage_t content;
+
+        // Collect exact keys of configs, and fill them with non-default values.
+        {
+            auto rg = config_registry::_internal_create(name);
+            startup_configs configs{rg, count};
+            rg->update();
+
+            configs_export(&content, false);
+            rg->unregister();
+        }
+
+        // Other registries' values are not touched.
+        global_config_storage_t imported;
+        auto& section = imported[name] = std::move(content[name]);
+
+        size_t index = 0;
+        for (auto& [key, value] : section) {
+            if (value.is_number()) {
+                value = int64_t(++index);
+            } else if (value.is_string()) {
+                value = "loaded string value " + std::to_string(++index);
+            } else {
+                value = std::vector<double>{1., 2., 3., double(++index)};
+            }
+        }
+
+        configs_import(std::move(imported));
+
+        auto rg = config_registry::_internal_create(name);
+        startup_configs configs{rg, count};
+
+        auto elapsed_import = measure_ms([&] { rg->update(); });
+
+        global_config_storage_t exported;
+        auto elapsed_export = measure_ms([&] { configs_export(&exported, false); });
+
+        report("register + import on first update()", count, elapsed_import);
+        report("export", exported[name].size(), elapsed_export);
+        rg->unregister();
+    }
+}
@@ -0,0 +1,93 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace perfkit_bench;
+
+/**
+ * Commit -> update -> notify latency of registries with 1k, 10k and 100k configs. Update
+ *  listeners are invoked synchronously inside update(), thus included in measured time.
+ */
+PERFKIT_BENCH_CASE(config_update_latency)
+{
+    using namespace perfkit::v2;
+
+    for (size_t count : {1'000, 10'000, 100'000}) {
+        auto rg = config_registry::_internal_create("bench.update." + std::to_string(count));
+        std::vector<config<int>> configs;
+        configs.reserve(count + 1);
+
+        auto elapsed_register = measure_ms([&] {
+            for (size_t i = 0; i < count; ++i) {
+                configs.push_back(make_config<int>("value" + std::to_string(i), 0));
+                configs.back().activate(rg);
+            }
+
+            rg->update();
+        });
+
+        size_t num_notified = 0;
+        for (auto& conf : configs) { conf.on_update(rg, [&](int const&) { ++num_notified; }); }
+
+        size_t const num_iter = 1000;
+        auto elapsed_single = measure_ms([&] {
+            for (size_t i = 0; i < num_iter; ++i) {
+                configs[(i * 7919) % count].commit(int(i));
+                rg->update();
+            }
+        });
+
+        auto elapsed_all = measure_ms([&] {
+            for (auto& conf : configs) { conf.commit(1); }
+            rg->update();
+        });
+
+        // Adding single config to a large registry must not rebuild whole key index.
+        configs.push_back(make_config<int>("value_added", 0));
+        configs.back().activate(rg);
+        auto elapsed_add = measure_ms([&] { rg->update(); });
+
+        auto elapsed_idle = measure_ms([&] {
+            for (size_t i = 0; i < num_iter; ++i) { rg->update(); }
+        });
+
+        char buf[64];
+        snprintf(buf, sizeof buf, "%zu configs: register all", count);
+        report(buf, count, elapsed_register);
+        snprintf(buf, sizeof buf, "%zu configs: commit one -> update", count);
+        report(buf, num_iter, elapsed_single);
+        snprintf(buf, sizeof buf, "%zu configs: commit all -> update", count);
+        report(buf, count, elapsed_all);
+        snprintf(buf, sizeof buf, "%zu configs: add one -> update", count);
+        report(buf, 1, elapsed_add);
+        snprintf(buf, sizeof buf, "%zu configs: update without change", count);
+        report(buf, num_iter, elapsed_idle);
+        printf("  (notified %zu)\n", num_notified);
+
+        rg->unregister();
+    }
+}
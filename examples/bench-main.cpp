@@ -0,0 +1,65 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <cstring>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace perfkit_bench {
+struct case_t {
+    char const* name;
+    case_fn_t fn;
+};
+
+static auto& all_cases()
+{
+    static std::vector<case_t> inst;
+    return inst;
+}
+
+int register_case(char const* name, case_fn_t fn)
+{
+    all_cases().push_back({name, fn});
+    return 0;
+}
+}  // namespace perfkit_bench
+
+/**
+ * Usage: perfkit-bench [name-filter]
+ */
+int main(int argc, char** argv)
+{
+    char const* filter = argc > 1 ? argv[1] : "";
+
+    for (auto& [name, fn] : perfkit_bench::all_cases()) {
+        if (strstr(name, filter) == nullptr) { continue; }
+
+        printf("[%s]\n", name);
+        fn();
+        fflush(stdout);
+    }
+
+    return 0;
+}
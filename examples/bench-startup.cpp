@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "perfkit/configs.h"
+
+/**
+ * Measures pre-main cost of PERFKIT_CFG. Heap allocations are counted from process start,
+ *  thus the count on entering main() is the one made during static initialization.
+ *
+ * Built as separate executable, as static initialization of other benchmarks would be
+ *  counted otherwise.
+ */
+static std::atomic_size_t g_num_alloc = 0;
+
+void* operator new(size_t size)
+{
+    g_num_alloc.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+#define BENCH_CFG_1(Prefix, N)                                                     \
+    PERFKIT_CFG(Prefix##_int##N, N).min(0).max(1000).description("Integer value"); \
+    PERFKIT_CFG(Prefix##_dbl##N, N * 0.5).clamp(0., 100.).hide();                  \
+    PERFKIT_CFG(Prefix##_str##N, "text").one_of({"text", "other", "another"});     \
+    PERFKIT_CFG(Prefix##_bool##N, false).transient()
+
+#define BENCH_CFG_10(Prefix, N) \
+    BENCH_CFG_1(Prefix, N##0);  \
+    BENCH_CFG_1(Prefix, N##1);  \
+    BENCH_CFG_1(Prefix, N##2);  \
+    BENCH_CFG_1(Prefix, N##3);  \
+    BENCH_CFG_1(Prefix, N##4);  \
+    BENCH_CFG_1(Prefix, N##5);  \
+    BENCH_CFG_1(Prefix, N##6);  \
+    BENCH_CFG_1(Prefix, N##7);  \
+    BENCH_CFG_1(Prefix, N##8);  \
+    BENCH_CFG_1(Prefix, N##9)
+
+#define BENCH_CFG_100(Prefix, N) \
+    BENCH_CFG_10(Prefix, N##0);  \
+    BENCH_CFG_10(Prefix, N##1);  \
+    BENCH_CFG_10(Prefix, N##2);  \
+    BENCH_CFG_10(Prefix, N##3);  \
+    BENCH_CFG_10(Prefix, N##4);  \
+    BENCH_CFG_10(Prefix, N##5);  \
+    BENCH_CFG_10(Prefix, N##6);  \
+    BENCH_CFG_10(Prefix, N##7);  \
+    BENCH_CFG_10(Prefix, N##8);  \
+    BENCH_CFG_10(Prefix, N##9)
+
+// 400 configs per class, 10 classes.
+#define BENCH_CFG_CLASS(ClassName) \
+    PERFKIT_CFG_CLASS(ClassName)   \
+    {                              \
+        BENCH_CFG_100(v, 1);       \
+    }
+
+BENCH_CFG_CLASS(bench_startup_0);
+BENCH_CFG_CLASS(bench_startup_1);
+BENCH_CFG_CLASS(bench_startup_2);
+BENCH_CFG_CLASS(bench_startup_3);
+BENCH_CFG_CLASS(bench_startup_4);
+BENCH_CFG_CLASS(bench_startup_5);
+BENCH_CFG_CLASS(bench_startup_6);
+BENCH_CFG_CLASS(bench_startup_7);
+BENCH_CFG_CLASS(bench_startup_8);
+BENCH_CFG_CLASS(bench_startup_9);
+
+int main()
+{
+    auto num_premain = g_num_alloc.load();
+    printf("[config_static_init]\n");
+    printf("  %-48s %10zu allocations\n", "pre-main, 4000 configs in 10 classes", num_premain);
+
+    // Attributes are built here, on first instantiation of each class.
+    auto num_before = g_num_alloc.load();
+    auto s0 = bench_startup_0::create("bench-startup-0");
+    auto s1 = bench_startup_1::create("bench-startup-1");
+    printf("  %-48s %10zu allocations\n", "first instantiation of 2 classes", g_num_alloc.load() - num_before);
+
+    num_before = g_num_alloc.load();
+    auto s0_2 = bench_startup_0::create("bench-startup-0-2");
+    printf("  %-48s %10zu allocations\n", "second instantiation of 1 class", g_num_alloc.load() - num_before);
+
+    return 0;
+}
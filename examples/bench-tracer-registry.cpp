@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "perfkit/traces.h"
+
+using namespace perfkit_bench;
+
+/**
+ * Tracers are created and destroyed in bulk, as on test_class reloads, while another thread
+ *  keeps listing them as terminal and net/web servers do.
+ */
+PERFKIT_BENCH_CASE(tracer_registry_churn)
+{
+    for (size_t num_tracers : {1000, 10000}) {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < num_tracers; ++i) { names.push_back("bench.tracer." + std::to_string(i)); }
+
+        std::vector<std::shared_ptr<perfkit::tracer>> tracers;
+        tracers.reserve(num_tracers);
+
+        std::atomic_bool stop = false;
+        std::atomic_size_t num_listed = 0;
+        std::thread reader{[&] {
+            while (not stop.load(std::memory_order_relaxed)) {
+                num_listed.fetch_add(perfkit::tracer::all().size(), std::memory_order_relaxed);
+            }
+        }};
+
+        auto elapsed_create = measure_ms([&] {
+            for (size_t i = 0; i < num_tracers; ++i) {
+                tracers.push_back(perfkit::tracer::create(int(i % 17), names[i]));
+            }
+        });
+
+        auto elapsed_destroy = measure_ms([&] {
+            // Destroy in creation order, which is the worst case of sorted removal.
+            for (auto& ptr : tracers) { ptr.reset(); }
+        });
+
+        stop = true;
+        reader.join();
+
+        report("create (concurrent listing)", num_tracers, elapsed_create);
+        report("destroy (concurrent listing)", num_tracers, elapsed_destroy);
+    }
+
+    // Listing cost alone, as polled by remote sessions.
+    std::vector<std::shared_ptr<perfkit::tracer>> tracers;
+    for (int i = 0; i < 1000; ++i) { tracers.push_back(perfkit::tracer::create(i, "bench.listed." + std::to_string(i))); }
+
+    size_t const num_iter = 10000;
+    size_t num_alive = 0;
+
+    auto elapsed_all = measure_ms([&] {
+        for (size_t i = 0; i < num_iter; ++i) { num_alive += perfkit::tracer::all().size(); }
+    });
+
+    auto elapsed_snapshot = measure_ms([&] {
+        for (size_t i = 0; i < num_iter; ++i) { num_alive += perfkit::tracer::all_snapshot()->size(); }
+    });
+
+    report("all() of 1000 tracers", num_iter, elapsed_all);
+    report("all_snapshot() of 1000 tracers", num_iter, elapsed_snapshot);
+    printf("  (checksum %zu)\n", num_alive);
+}
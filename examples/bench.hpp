@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2021-2022. Seungwoo Kang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// project home: https://github.com/perfkitpp
+
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "perfkit/configs.h"
+
+/**
+ * Minimal benchmark harness. Each case registers itself on static initialization, and
+ *  perfkit-bench runs every case whose name contains the first command line argument.
+ */
+namespace perfkit_bench {
+using clock_type = std::chrono::steady_clock;
+using case_fn_t = void (*)();
+
+int register_case(char const* name, case_fn_t fn);
+
+//! Runs fn once, and returns elapsed time in milliseconds.
+template <typename Fn>
+double measure_ms(Fn&& fn)
+{
+    auto begin = clock_type::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(clock_type::now() - begin).count();
+}
+
+//! Create config of given key and default value, out of any config set.
+template <typename ValueType>
+auto make_config(std::string const& key, ValueType default_value)
+{
+    using namespace perfkit::v2;
+    auto attrib = config_attribute_factory<ValueType>{key}
+                          ._internal_default_value(std::move(default_value))
+                          .confirm();
+
+    return config<ValueType>{std::move(attrib)};
+}
+
+inline void report(std::string_view label, size_t count, double elapsed_ms)
+{
+    printf("  %-48.*s %10zu items %12.3f ms %12.1f ns/item\n",
+           int(label.size()), label.data(), count, elapsed_ms, count ? elapsed_ms * 1e6 / count : 0.);
+}
+}  // namespace perfkit_bench
+
+#define PERFKIT_BENCH_CASE(Name)                                                               \
+    static void _perfkit_bench_##Name();                                                       \
+    static int const _perfkit_bench_reg_##Name                                                 \
+            = ::perfkit_bench::register_case(#Name, &_perfkit_bench_##Name);                   \
+    static void _perfkit_bench_##Name()
@@ -13,6 +13,10 @@ class AppBase
    public:
     virtual ~AppBase() noexcept = default;
 
+   public:
+    //! Return this from S00_ParseCommandLineArgs() to quit with exit status 0, e.g. on '--help'.
+    static constexpr int QuitSuccessfully = -1;
+
    public:
     virtual std::string DefaultConfigPath() const noexcept { return ""; }
     virtual int S00_ParseCommandLineArgs(int argc, char** argv);
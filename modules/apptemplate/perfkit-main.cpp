@@ -57,7 +57,7 @@ int main(int argc, char** argv)
 
     if (auto rflag = app->S00_ParseCommandLineArgs(argc, argv)) {
         // Non-zero returned during argument parsing.
-        return rflag;
+        return rflag == perfkit::AppBase::QuitSuccessfully ? 0 : rflag;
     }
 
     spdlog::info("APP INIT 0 - PreLoadConfigs");
@@ -88,11 +88,14 @@ int main(int argc, char** argv)
 
     if (not app->HasCustomConfig()) {
         perfkit::terminal::register_conffile_io_commands(term.get());
+        perfkit::terminal::register_conffile_watch_command(term.get());
     } else {
         term->add_command("save-config", [app = app.get()] { app->CustomSaveConfig(); });
         term->add_command("load-config", [app = app.get()] { app->CustomLoadConfig(); });
     }
 
+    perfkit::terminal::register_config_history_command(term.get());
+
     // Install signal handler
     signal(SIGINT, &sigint_handler);
 
@@ -144,6 +147,10 @@ int perfkit::AppBase::S00_ParseCommandLineArgs(int argc, char** argv)
         spdlog::info("Parsing {} command line arguments", argc);
         perfkit::configs_parse_args(argc, (const char**&)argv);
         return 0;
+    } catch (perfkit::configs_parse_help_exception& e) {
+        // Help requested; print it and quit.
+        fputs(e.what(), stdout);
+        return QuitSuccessfully;
     } catch (std::exception& e) {
         spdlog::error("Error during flag parsing: \n{}", e.what());
         return 1;
@@ -49,7 +49,8 @@
     }
 
 /**
- * This defines attribute variable as static inline, which causes overhead on program startup.
+ * Attribute calls chained after this macro are only recorded on static initialization. The
+ *  attribute itself is built when owning config set is instantiated for the first time.
  */
 #define PERFKIT_CFG(VarName, ...)                                                                 \
     using INTERNAL_CPPH_CONCAT(_internal_type_, VarName)                                          \
@@ -58,18 +59,19 @@
                                                                                                   \
     INTL_PERFKIT_NS_0::config<INTERNAL_CPPH_CONCAT(_internal_type_, VarName)>                     \
             VarName{(INTERNAL_CPPH_CONCAT(_internal_perfkit_register_conf_, VarName)(),           \
-                     INTERNAL_CPPH_CONCAT(_internal_perfkit_attribute_, VarName))};               \
+                     INTERNAL_CPPH_CONCAT(_internal_perfkit_attribute_, VarName).get())};         \
                                                                                                   \
     static void INTERNAL_CPPH_CONCAT(_internal_perfkit_register_conf_, VarName)()                 \
     {                                                                                             \
         static auto once = INTL_PERFKIT_NS_1::register_conf_function(&_internal_self_t::VarName); \
     }                                                                                             \
                                                                                                   \
-    static inline const INTL_PERFKIT_NS_0::config_attribute_ptr                                   \
-    INTERNAL_CPPH_CONCAT(_internal_perfkit_attribute_, VarName)                                   \
-            = INTL_PERFKIT_NS_0::config_attribute_factory<decltype(VarName)::value_type>{         \
-                    #VarName, INTL_PERFKIT_NS_1::name_from_va_arg(__VA_ARGS__)}                   \
-                      ._internal_default_value(INTL_PERFKIT_NS_1::default_from_va_arg(__VA_ARGS__))
+    static inline const auto                                                                      \
+            INTERNAL_CPPH_CONCAT(_internal_perfkit_attribute_, VarName)                           \
+            = INTL_PERFKIT_NS_1::make_lazy_attribute<                                             \
+                    INTERNAL_CPPH_CONCAT(_internal_type_, VarName)>(                              \
+                    #VarName, INTL_PERFKIT_NS_1::name_from_va_arg(__VA_ARGS__),                   \
+                    [] { return INTL_PERFKIT_NS_1::default_from_va_arg(__VA_ARGS__); })
 
 /**
  *
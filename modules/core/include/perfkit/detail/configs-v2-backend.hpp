@@ -25,8 +25,12 @@
  ******************************************************************************/
 
 #pragma once
+#include <chrono>
+#include <mutex>
 #include <shared_mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "configs-v2.hpp"
 #include "cpph/memory/pool.hxx"
@@ -35,18 +39,98 @@
 #include "cpph/thread/event_queue.hxx"
 #include "cpph/utility/event.hxx"
 
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
 namespace cpph {
 using std::list;
 }
 
 namespace perfkit::v2 {
+namespace _configs {
+/**
+ * Set of slot indices, which are consumed in ascending order. Cost of consumption is
+ *  proportional to number of words, not slots.
+ */
+class slot_bitset
+{
+    vector<uint64_t> _words;
+
+   public:
+    void reserve_slots(size_t num_slots)
+    {
+        if (_words.size() * 64 < num_slots) { _words.resize((num_slots + 63) / 64); }
+    }
+
+    void set(size_t slot) noexcept { _words[slot / 64] |= uint64_t(1) << (slot % 64); }
+
+    void reset(size_t slot) noexcept
+    {
+        if (slot / 64 < _words.size()) { _words[slot / 64] &= ~(uint64_t(1) << (slot % 64)); }
+    }
+
+    template <typename Fn>
+    void consume(Fn&& fn)
+    {
+        for (size_t index = 0; index < _words.size(); ++index)
+            for (auto word = std::exchange(_words[index], 0); word != 0; word &= word - 1)
+                fn(index * 64 + _count_trailing_zeros(word));
+    }
+
+   private:
+    static size_t _count_trailing_zeros(uint64_t v) noexcept
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, v);
+        return index;
+#else
+        return __builtin_ctzll(v);
+#endif
+    }
+};
+}  // namespace _configs
+
+/**
+ * Commit which was rejected by asynchronous validation
+ */
+struct config_commit_rejection {
+    config_id_t id;
+    weak_ptr<void> origin;  // Given by the committer, to identify where the commit came from
+};
+
+/**
+ * Single change record of registry history
+ */
+struct config_history_entry {
+    size_t fence = 0;  // Registry fence on which the change became visible
+    std::chrono::system_clock::time_point timestamp;
+
+    config_id_t id = {};
+    string_view key;     // Refers to interned key
+    string_view source;  // Static string, which describes where the change came from
+
+    // msgpack encoded old value, followed by new value.
+    string payload;
+    size_t new_value_offset = 0;
+
+   public:
+    string_view old_value() const noexcept { return string_view{payload}.substr(0, new_value_offset); }
+    string_view new_value() const noexcept { return string_view{payload}.substr(new_value_offset); }
+};
+
 struct config_entity_context {
     friend class config_registry;
 
    public:
     config_base_wptr reference;
     size_t sort_order = 0;
-    string full_key_cached;
+    string_view full_key_cached;  // Refers to interned key
+    config_id_t id = {};          // Zero if this slot is vacant
+    _configs::interned_key const* interned_key = nullptr;
+    uint64_t commit_seq = 0;      // Discards outdated asynchronous validation results
+    string_view staged_source;    // Source of staged value, for history
 
    private:
     refl::shared_object_ptr _staged;
@@ -72,6 +156,13 @@ class config_registry::backend_t
     atomic_bool _has_expired_ref = false;
     bool _is_global = false;
 
+    // Propagation worker mode. See config_registry::use_propagation_worker()
+    atomic_bool _use_propagation_worker = false;
+    atomic_bool _propagation_pending = false;
+
+    // Serializes _do_update() between user thread and propagation worker
+    std::mutex _mtx_update;
+
     // Event queue for event joining
     event_queue _events{1024};
 
@@ -82,36 +173,95 @@ class config_registry::backend_t
     atomic_size_t _fence = 0;
     atomic_size_t _sort_id_gen = 0;
 
-    // All active config entities.
-    std::unordered_map<config_id_t, config_entity_context> _configs;
-    map<string, config_id_t> _key_id_table;
+    // All active config entities, in flat storage. Slot of each entity is kept during its
+    //  lifetime, and vacant slots are reused by later additions.
+    vector<config_entity_context> _slots;
+    vector<uint32_t> _vacant_slots;
+    std::unordered_map<config_id_t, uint32_t> _slot_table;
+
+    // Configs by interned key. First config of each key owns it, and the others with same key
+    //  are kept to take over the ownership when the owner is released.
+    struct key_owner_t {
+        config_id_t owner;
+        vector<config_id_t> successors;
+    };
+
+    std::unordered_map<_configs::interned_key const*, key_owner_t> _key_owners;
 
-    // Set of queued updates
-    vector<config_id_t> _refreshed_items;
-    vector<config_id_t> _inplace_updates;
+    // Slots of queued updates
+    _configs::slot_bitset _dirty_staged;
+    _configs::slot_bitset _dirty_inplace;
 
     // Item insertion/deletions management
     bool _flag_add_remove_notified = true;
     flat_map<config_base_wptr, tuple<size_t>, std::owner_less<>> _config_added;
     vector<config_base_wptr> _config_removed;
 
-    // For events, Every event nodes can be reused.
-    list<config_base_ptr> _free_evt_nodes;
+    // Reused on every update, to collect updated configs.
+    vector<config_base_ptr> _update_buffer;
+
+    // Staged objects swapped out during update. Released at once after leaving the
+    //  protected scope, to return them to staging pool in batch.
+    vector<refl::shared_object_ptr> _retired_staged;
+
+    // Bounded history of applied changes, stored as ring. Payload buffers of overwritten
+    //  entries are reused, thus no allocation is made once the ring is filled up.
+    mutable std::mutex _mtx_history;
+    vector<config_history_entry> _history;
+    size_t _history_begin = 0;
+    size_t _history_capacity = 128;
+    size_t _history_lost_fence = 0;  // Fence of the latest change dropped from ring
+
+    // Changes applied during update, which are encoded into history after leaving the
+    //  protected scope. Old values are kept alive in _retired_staged until then.
+    struct history_pending_t {
+        size_t update_index;   // Index of the updated config in _update_buffer
+        size_t retired_index;  // Index of the old value in _retired_staged
+        config_id_t id;
+        string_view source;
+    };
+
+    vector<history_pending_t> _history_pending;
+    string _history_scratch;
+
+    // Rejections from asynchronous validation, which are published on next update.
+    vector<config_commit_rejection> _rejections;
+    vector<config_commit_rejection> _rejection_buffer;
 
    public:
     static inline event<config_registry_ptr> g_evt_registered;
     static inline event<weak_ptr<config_registry>> g_evt_unregistered;
 
-    event<config_registry*, list<config_base_ptr> const&> evt_updated_entities;
+    event<config_registry*, vector<config_base_ptr> const&> evt_updated_entities;
+    event<config_registry*, vector<config_commit_rejection> const&> evt_commit_rejected;
     event<config_registry*> evt_structure_changed;
     event<config_registry*> evt_update_listener;
+    event<config_registry*> evt_fence_updated;
 
    private:
     void _register_to_global_repo();
 
     void _do_update();
     bool _handle_structure_update();
-    bool _commit(config_base*, refl::shared_object_ptr);
+    bool _commit(config_base*, refl::shared_object_ptr, weak_ptr<void> origin = {}, string_view source = "local");
+    void _commit_validated(config_base*, refl::shared_object_ptr, weak_ptr<void> origin, string_view source, uint64_t seq, bool valid);
+    bool _commit_batch(array_view<pair<config_base_ptr, refl::shared_object_ptr>>, string_view source = "local");
+    void _record_history(size_t fence) noexcept;
+
+    // Slot management. Must be called under protection of _mtx_access.
+    config_entity_context* _find_slot(config_id_t id) noexcept;
+    config_entity_context const* _find_slot(config_id_t id) const noexcept;
+    config_entity_context* _acquire_slot(config_id_t id);
+    void _release_slot(config_entity_context* ctx);
+    void _own_key(config_entity_context* ctx, _configs::interned_key const* key);
+    void _disown_key(config_entity_context* ctx);
+
+    template <typename Fn>
+    void _for_each_slot(Fn&& fn) const
+    {
+        for (auto& ctx : _slots)
+            if (ctx.id.value != 0) { fn(ctx); }
+    }
 
    public:
     explicit backend_t(config_registry* self, string name, bool is_global)
@@ -120,11 +270,38 @@ class config_registry::backend_t
    public:
     void _internal_notify_config_disposal() { release(_has_expired_ref, true); }
     bool _internal_commit_inplace(config_base*, refl::object_view_t);
+    void _internal_request_propagation();
+    void _internal_propagate();
 
    public:
     void bk_all_items(vector<config_base_ptr>*) const noexcept;
-    bool bk_commit(config_base*, archive::if_reader* content);
-    bool bk_commit(config_id_t, archive::if_reader* content);
+
+    /**
+     * Commit serialized content. If config validates asynchronously, returns true as soon as
+     *  content is parsed, and rejection is published later via evt_commit_rejected with
+     *  given origin.
+     */
+    bool bk_commit(config_base*, archive::if_reader* content, weak_ptr<void> origin = {}, string_view source = "remote");
+    bool bk_commit(config_id_t, archive::if_reader* content, weak_ptr<void> origin = {}, string_view source = "remote");
+
+    /**
+     * Change history. Each staged commit applied by update() is recorded with its previous
+     *  value, up to capacity. Setting capacity 0 disables recording. Source strings given
+     *  to commit functions must have static lifetime.
+     *
+     * In-place modifications (e.g. config<T>::set()) are not recorded, as the previous value
+     *  is overwritten in place and never retained.
+     */
+    void bk_history_capacity(size_t capacity);
+    void bk_history(vector<config_history_entry>* out) const;
+
+    /**
+     * Restore every config changed after given fence to its value at the fence, as single
+     *  transaction. Fails if any of those changes has already been dropped from history.
+     *  In-place modifications are not reverted, as they are not part of the history.
+     */
+    bool bk_rollback(size_t fence);
+    config_base_ptr bk_find(config_id_t) const noexcept;
     void bk_notify() { evt_update_listener.invoke(_owner); }
 
     template <class AccessFn>
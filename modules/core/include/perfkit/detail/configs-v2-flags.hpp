@@ -38,12 +38,33 @@ struct config_parse_arg_option {
     bool is_first_arg_exec_name = true;
 };
 
-// TODO:
-//   parse_args default takes list of active config options or config registries
-//   if nothing is specified, parse_args will collect all globally registered
-//    config registry instances, and will create flag binding table, then perform
-//    args parsing.
-//
+/**
+ * Thrown by configs_parse_args() on '--help' or '-h', unless those are bound to any config.
+ *  what() returns help string, which describes every bound flag.
+ */
+class configs_parse_help_exception : public std::exception
+{
+    string _help;
+
+   public:
+    explicit configs_parse_help_exception(string help) noexcept : _help(move(help)) {}
+    char const* what() const noexcept override { return _help.c_str(); }
+};
+
+/**
+ * Parse command line arguments into flag-bound configs of given registries. If no registry
+ *  is specified, all globally registered registries are collected.
+ *
+ *      --flag, --no-flag           Set boolean flag true/false
+ *      --flag=value, --flag value  Set non-boolean flag
+ *      -abc, -Nabc                 Set each boolean single character flag true/false
+ *      -xvalue, -x value           Set non-boolean single character flag
+ *      --                          Stop parsing
+ *
+ * Array values are given as comma separated list. Parsed values are committed, thus they
+ *  become visible on next update() of each registry. Throws std::runtime_error on invalid
+ *  flag or value, and configs_parse_help_exception on help request.
+ */
 void configs_parse_args(
         int& ref_argc, char const**& ref_argv,
         config_parse_arg_option option = {},
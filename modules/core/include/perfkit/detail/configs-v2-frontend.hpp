@@ -25,6 +25,10 @@
  ******************************************************************************/
 
 #pragma once
+#include <array>
+#include <mutex>
+#include <tuple>
+
 #include "configs-v2.hpp"
 #include "cpph/helper/macros.hxx"
 
@@ -43,6 +47,13 @@ class config_set_base
         size_t property_offset;
         void (*fn_init)(config_set_base* base, void* prop_addr);
         void (*fn_deinit)(void* prop_addr);  // TODO: Logics for deactivation ...
+        void (*fn_freeze)(void* prop_addr);
+    };
+
+    struct _internal_snapshot_slot {
+        std::once_flag init_flag;
+        shared_ptr<void const> latest;  // Must be accessed atomically
+        void (*fn_rebuild)(_internal_snapshot_slot*) = nullptr;
     };
 
     struct _internal_pfx_node {
@@ -63,11 +74,13 @@ class config_set_base
     static thread_local inline _internal_next_ctor_param_t _internal_next_ctor_param = {};
     shared_ptr<config_registry> _internal_RG;
     shared_ptr<_internal_pfx_node> _internal_prefix;
+    shared_ptr<_internal_snapshot_slot> _internal_snapshot;
 
    public:
     config_set_base() noexcept
             : _internal_RG(exchange(_internal_next_ctor_param.config_registry, nullptr)),
-              _internal_prefix(exchange(_internal_next_ctor_param.prefix, nullptr))
+              _internal_prefix(exchange(_internal_next_ctor_param.prefix, nullptr)),
+              _internal_snapshot(make_shared<_internal_snapshot_slot>())
     {
     }
 
@@ -86,6 +99,18 @@ class config_set_base
         }
     }
 
+    static void _internal_perform_freeze(config_set_base* base_addr, array_view<_internal_initops_t const> initops)
+    {
+        // Snapshots are detached from registry, to prevent reference cycle via update event.
+        base_addr->_internal_RG.reset();
+        base_addr->_internal_snapshot.reset();
+
+        for (auto& op : initops) {
+            void* property = (char*)base_addr + op.property_offset;
+            op.fn_freeze(property);
+        }
+    }
+
    public:
     static auto _internal_get_RG(config_set_base* b) { return b->_internal_RG; }
     static auto const& _internal_get_prefix(config_set_base* b) { return b->_internal_prefix; }
@@ -158,6 +183,54 @@ class config_set : public config_set_base
         }
     }
 
+    using snapshot_ptr = shared_ptr<ImplType const>;
+
+    /**
+     * Returns immutable copy of every config in this set, which were captured at the same
+     *  registry fence. Snapshot is rebuilt once per update() that applied any change, and
+     *  published via atomic pointer swap, thus readers never observe half-updated set.
+     *
+     * Snapshot is detached from registry. Only value accessors of its configs are valid.
+     */
+    snapshot_ptr snapshot() const
+    {
+        auto slot = _internal_snapshot.get();
+        assert(slot && "Snapshot of snapshot is not allowed!");
+
+        std::call_once(slot->init_flag, [this, slot] {
+            // Holding update lock, no update can be applied between first build and hook
+            //  registration. Otherwise snapshot may stay stale until next update.
+            auto update_lock = _internal_RG->_internal_lock_update();
+
+            auto first = make_shared<ImplType>(static_cast<ImplType const&>(*this));
+            _internal_perform_freeze(first.get(), *_internal_initops());
+
+            slot->fn_rebuild = &config_set::_internal_rebuild_snapshot;
+            std::atomic_store_explicit(&slot->latest, shared_ptr<void const>{move(first)}, std::memory_order_release);
+
+            _internal_RG->on_fence_update()
+                    << weak_ptr{_internal_snapshot}
+                    << [wslot = weak_ptr{_internal_snapshot}](config_registry*) {
+                           if (auto slot = wslot.lock()) { slot->fn_rebuild(slot.get()); }
+                       };
+        });
+
+        auto latest = std::atomic_load_explicit(&slot->latest, std::memory_order_acquire);
+        return std::static_pointer_cast<ImplType const>(move(latest));
+    }
+
+   private:
+    static void _internal_rebuild_snapshot(_internal_snapshot_slot* slot)
+    {
+        auto prev = std::static_pointer_cast<ImplType const>(std::atomic_load(&slot->latest));
+
+        // Configs of frozen copy still refer to their live values.
+        auto next = make_shared<ImplType>(*prev);
+        _internal_perform_freeze(next.get(), *_internal_initops());
+
+        std::atomic_store_explicit(&slot->latest, shared_ptr<void const>{move(next)}, std::memory_order_release);
+    }
+
    public:
     //! Only for category subprocess usage ...
     static ImplType _bk_make_subobj(config_set_base* base, char const* memvar, char const* user_provided = nullptr)
@@ -221,6 +294,9 @@ nullptr_t register_conf_function(Config ConfigSet::*mptr) noexcept
     initop->fn_deinit = [](void* p) {
         ((Config*)p)->force_deactivate();
     };
+    initop->fn_freeze = [](void* p) {
+        ((Config*)p)->_internal_freeze();
+    };
 
     return nullptr;
 }
@@ -240,6 +316,9 @@ nullptr_t register_subset_function(Subset ConfigSet::*mptr) noexcept
     initop->fn_deinit = [](void* p) {
         ((Subset*)p)->force_deactivate();
     };
+    initop->fn_freeze = [](void* p) {
+        Subset::_internal_perform_freeze((Subset*)p, *Subset::_internal_initops());
+    };
 
     return nullptr;
 }
@@ -442,6 +521,17 @@ class config_attribute_factory
         return *this;
     }
 
+    /**
+     * Run validators on background worker, for expensive validation. commit() returns
+     *  immediately, and value is applied on the first update() after validation succeeds.
+     *  set() and transactions are still validated synchronously.
+     */
+    auto& async_validate() noexcept
+    {
+        _ref->async_validate = true;
+        return *this;
+    }
+
     /** expose entities as flags. configs MUST NOT BE field of any config template class! */
     template <typename... Str_>
     auto& flags(Str_&&... args) noexcept
@@ -483,7 +573,13 @@ class config_attribute_factory
         return *this;
     }
 
-    /** initialize from environment variable */
+    /**
+     * Initialize from environment variable, when the config is added to registry. Value is
+     *  parsed as json, or used as string if it's not valid json.
+     *
+     * Precedence: default < config file < environment < command line flags. Importing or
+     *  reloading config file later doesn't override environment value.
+     */
     auto& env(string s) noexcept
     {
         assert(_ref->env_binding.empty());
@@ -507,6 +603,179 @@ class config_attribute_factory
     }
 };
 
+namespace _configs {
+/**
+ * Records calls to config_attribute_factory, and replays them when the attribute is requested
+ *  for the first time. Used by PERFKIT_CFG, to defer attribute construction from static
+ *  initialization to the first instantiation of owning config set.
+ *
+ * Every recorded call keeps its arguments by value, thus usually no allocation is made until
+ *  the attribute is actually built.
+ */
+template <typename ValTy, typename DefaultFn, typename... Ops>
+class lazy_attribute_factory
+{
+    template <typename, typename, typename...>
+    friend class lazy_attribute_factory;
+
+    string_view _key;
+    string_view _alias;
+    DefaultFn _fn_default;
+    std::tuple<Ops...> _ops;
+
+    mutable std::once_flag _once;
+    mutable config_attribute_ptr _instance;
+
+   public:
+    lazy_attribute_factory(string_view key, string_view alias, DefaultFn fn_default) noexcept
+            : _key(key), _alias(alias), _fn_default(move(fn_default)) {}
+
+   private:
+    lazy_attribute_factory(string_view key, string_view alias, DefaultFn fn_default, std::tuple<Ops...> ops) noexcept
+            : _key(key), _alias(alias), _fn_default(move(fn_default)), _ops(move(ops)) {}
+
+    template <typename Op>
+    auto _then(Op op) &&
+    {
+        return lazy_attribute_factory<ValTy, DefaultFn, Ops..., Op>{
+                _key, _alias, move(_fn_default), std::tuple_cat(move(_ops), std::make_tuple(move(op)))};
+    }
+
+    template <typename Elem, size_t N>
+    auto _one_of_elems(Elem const (&values)[N]) &&
+    {
+        std::array<Elem, N> elems;
+        std::copy(std::begin(values), std::end(values), elems.begin());
+
+        return move(*this)._then([elems = move(elems)](auto& f) { f.one_of(elems); });
+    }
+
+   public:
+    //! Build attribute on first call.
+    config_attribute_ptr const& get() const
+    {
+        std::call_once(_once, [this] {
+            config_attribute_factory<ValTy> factory{_key, _alias};
+            factory._internal_default_value(_fn_default());
+            std::apply([&](auto const&... op) { (op(factory), ...); }, _ops);
+
+            _instance = factory.confirm();
+        });
+
+        return _instance;
+    }
+
+   public:
+    template <size_t N>
+    auto description(char const (&content)[N]) &&
+    {
+        return move(*this)._then([&content](auto& f) { f.description(content); });
+    }
+
+    auto edit_mode(v2::edit_mode mode) &&
+    {
+        return move(*this)._then([mode](auto& f) { f.edit_mode(mode); });
+    }
+
+    auto min(ValTy value) &&
+    {
+        return move(*this)._then([value = move(value)](auto& f) { f.min(value); });
+    }
+
+    auto max(ValTy value) &&
+    {
+        return move(*this)._then([value = move(value)](auto& f) { f.max(value); });
+    }
+
+    auto clamp(ValTy minv, ValTy maxv) &&
+    {
+        return move(*this)._then([minv = move(minv), maxv = move(maxv)](auto& f) { f.clamp(minv, maxv); });
+    }
+
+    template <typename Iterable>
+    auto one_of(Iterable&& iterable) &&
+    {
+        return move(*this)._then([values = decay_t<Iterable>(forward<Iterable>(iterable))](auto& f) { f.one_of(values); });
+    }
+
+    /**
+     * Braced list is kept in fixed-size array as given, e.g. string literals are kept as
+     *  pointers. Value list is built from them only when the attribute is built.
+     */
+    template <typename Elem, size_t N>
+    auto one_of(Elem const (&values)[N]) &&
+    {
+        return move(*this)._one_of_elems(values);
+    }
+
+    //! Used when elements of braced list are not of single type, e.g. {1, 2.5}
+    template <size_t N>
+    auto one_of(ValTy const (&values)[N]) &&
+    {
+        return move(*this)._one_of_elems(values);
+    }
+
+    auto hide() &&
+    {
+        return move(*this)._then([](auto& f) { f.hide(); });
+    }
+
+    template <typename Pred>
+    auto validate(Pred&& pred) &&
+    {
+        return move(*this)._then([pred = forward<Pred>(pred)](auto& f) { f.validate(pred); });
+    }
+
+    template <typename Pred>
+    auto verify(Pred&& pred) &&
+    {
+        return move(*this)._then([pred = forward<Pred>(pred)](auto& f) { f.verify(pred); });
+    }
+
+    auto async_validate() &&
+    {
+        return move(*this)._then([](auto& f) { f.async_validate(); });
+    }
+
+    template <typename... Str_>
+    auto flags(Str_&&... args) &&
+    {
+        return move(*this)._then(
+                [args = std::make_tuple(decay_t<Str_>(forward<Str_>(args))...)](auto& f) {
+                    std::apply([&](auto const&... e) { f.flags(e...); }, args);
+                });
+    }
+
+    auto transient() &&
+    {
+        return move(*this)._then([](auto& f) { f.transient(); });
+    }
+
+    auto readonly() &&
+    {
+        return move(*this)._then([](auto& f) { f.readonly(); });
+    }
+
+    template <typename Str>
+    auto env(Str&& s) &&
+    {
+        return move(*this)._then([s = decay_t<Str>(forward<Str>(s))](auto& f) { f.env(string{s}); });
+    }
+
+    //! Kept for compatibility with eager factory. Validation is deferred to get().
+    auto confirm() &&
+    {
+        return lazy_attribute_factory{_key, _alias, move(_fn_default), move(_ops)};
+    }
+};
+
+template <typename ValTy, typename DefaultFn>
+auto make_lazy_attribute(string_view key, string_view alias, DefaultFn fn_default) noexcept
+{
+    return lazy_attribute_factory<ValTy, DefaultFn>{key, alias, move(fn_default)};
+}
+}  // namespace _configs
+
 namespace _configs {
 //! \see https://stackoverflow.com/questions/24855160/how-to-tell-if-a-c-template-type-is-c-style-string
 template <typename Ty_, typename = void>
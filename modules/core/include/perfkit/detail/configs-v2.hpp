@@ -25,6 +25,9 @@
  ******************************************************************************/
 
 #pragma once
+#include <chrono>
+#include <cstring>
+#include <mutex>
 #include <utility>
 
 #include "configs-edit_mode.hxx"
@@ -41,6 +44,7 @@
 namespace perfkit::v2 {
 class config_registry;
 class config_base;
+class config_transaction;
 struct config_attribute;
 
 using config_base_ptr = shared_ptr<config_base>;
@@ -62,11 +66,51 @@ using config_data = binary<string>;
 using config_registry_storage_t = std::map<std::string, nlohmann::json, std::less<>>;
 using global_config_storage_t = std::map<std::string, config_registry_storage_t, std::less<>>;
 void configs_import(global_config_storage_t json_content);
-bool configs_import(string_view path);
-void configs_export(global_config_storage_t* json_dst, bool merge = true);
-bool configs_export(string_view path, bool merge = true);
+
+/**
+ * Import config file. File is only indexed on import, and each value is parsed when its
+ *  registry actually requires it. Optionally, the file can be memory-mapped instead of read.
+ */
+bool configs_import(string_view path, bool use_mmap = false);
+/**
+ * Export configs. If non_default_only is set, values of alive configs which are identical
+ *  with their defaults are omitted.
+ */
+void configs_export(global_config_storage_t* json_dst, bool merge = true, bool non_default_only = false);
+
+/**
+ * Export configs to file. If path ends with '.pkcfg', configs are written in indexed binary
+ *  format, which can be imported with configs_import() as well as json.
+ *
+ * File is replaced atomically by writing temporary file and renaming it. Writing is skipped
+ *  if content is identical with the one previously exported to the same path.
+ */
+bool configs_export(string_view path, bool merge = true, bool non_default_only = false);
+
+/**
+ * Convert config file between json and binary format. Output format is determined by
+ *  destination path, as same as configs_export().
+ */
+bool configs_convert(string_view src_path, string_view dst_path);
+
 auto configs_export_dump(int indent = -1, bool merge = true) -> string;
 
+/**
+ * Reload config file, and commit only the values that differ from the ones previously
+ *  imported or exported. Values which are not listed in the file are left untouched.
+ */
+bool configs_reload(string_view path);
+
+/**
+ * Watch config file, and reload it with configs_reload() whenever it changes. Bursts of
+ *  file events within debounce interval are merged into single reload.
+ *
+ * Watching stops when returned handle is released. Returns null if file watching is not
+ *  supported on current platform.
+ */
+auto configs_watch(string_view path, std::chrono::milliseconds debounce = std::chrono::milliseconds{200})
+        -> shared_ptr<void>;
+
 /**
  * Key rules
  *
@@ -98,6 +142,10 @@ struct config_attribute {
     ufunction<bool(refl::object_view_t)> fn_validate;
     ufunction<bool(refl::object_view_t)> fn_minmax_validate;
 
+    // If set, committed values are validated on background worker instead of committing
+    //  thread. Rejections are reported through backend on next update().
+    bool async_validate = false;
+
     //
     bool can_import = true;
     bool can_export = true;
@@ -148,6 +196,29 @@ class config_update_monitor
     }
 };
 
+namespace _configs {
+/**
+ * Full key interned in process-wide arena. Interned keys are never released, thus their
+ *  string views stay valid for the whole process lifetime.
+ */
+struct interned_key {
+    string_view str;
+    size_t hash = 0;
+};
+
+//! Returns same instance for same key.
+interned_key const* intern_key(string_view key);
+
+//! Excludes a parameter from template argument deduction. Equivalent of C++20 std::type_identity_t.
+template <typename Ty_>
+struct type_identity {
+    using type = Ty_;
+};
+
+template <typename Ty_>
+using type_identity_t = typename type_identity<Ty_>::type;
+}  // namespace _configs
+
 /**
  * basic config class
  */
@@ -162,6 +233,10 @@ class config_base : public std::enable_shared_from_this<config_base>
 
         // Absolute
         config_attribute_ptr attribute;
+
+        // Set if raw data is trivially copyable, to enable lock-free read path.
+        void const* trivial_data = nullptr;
+        size_t trivial_size = 0;
     };
 
    private:
@@ -170,17 +245,29 @@ class config_base : public std::enable_shared_from_this<config_base>
 
     mutable shared_spinlock _mtx_raw_access;
     init_info_t _body;
+
+    // Lock-free read path for trivially copyable values.
+    //  - Values fit in 8 bytes are mirrored to _raw_scalar on every modification.
+    //  - Larger ones are read directly from raw data, guarded by sequence counter.
+    std::atomic_size_t _raw_sequence = 0;
+    std::atomic_uint64_t _raw_scalar = 0;
+
     shared_ptr<config_registry> _rg;
 
     // Managed by repository
     mutable spinlock _mtx_full_key;
-    string _cached_full_key;
-    string_view _cached_prefix;
+
+    // Published once on activation. Readers access it without any lock.
+    std::atomic<_configs::interned_key const*> _key = nullptr;
 
     std::atomic_size_t _fence_modified = 0;  // Actual modification count
 
    public:
-    explicit config_base(init_info_t&& info) noexcept : _body(move(info)) {}
+    //! Invoked after every value update is applied, from the thread which performed update.
+    event<config_base*> on_update;
+
+   public:
+    explicit config_base(init_info_t&& info) noexcept : _body(move(info)) { _publish_raw(); }
     ~config_base() noexcept;
 
     auto const& attribute() const noexcept { return _body.attribute; }
@@ -198,16 +285,74 @@ class config_base : public std::enable_shared_from_this<config_base>
     bool can_import() const noexcept { return attribute()->can_import; }
     bool is_hidden() const noexcept { return attribute()->hidden; }
 
-    auto full_key() const noexcept { return lock_guard{_mtx_full_key}, _cached_full_key; }
-    auto prefix() const noexcept { return lock_guard{_mtx_full_key}, string{_cached_prefix}; }
-    auto prefix_length() const noexcept { return lock_guard{_mtx_full_key}, _cached_prefix.size(); }
-    void full_key(string* v) const noexcept { lock_guard{_mtx_full_key}, *v = _cached_full_key; }
+    //! Returned view is valid for process lifetime. Empty if config was never activated.
+    string_view full_key() const noexcept
+    {
+        auto key = _key.load(std::memory_order_acquire);
+        return key ? key->str : string_view{};
+    }
+
+    size_t full_key_hash() const noexcept
+    {
+        auto key = _key.load(std::memory_order_acquire);
+        return key ? key->hash : 0;
+    }
+
+    string_view prefix() const noexcept
+    {
+        auto key = full_key();
+        return key.empty() ? key : key.substr(0, key.size() - name().size());
+    }
+
+    auto prefix_length() const noexcept { return prefix().size(); }
+    void full_key(string* v) const noexcept { *v = full_key(); }
 
     auto owner() const noexcept { return lock_guard{_mtx_full_key}, _rg; }
 
    public:
     void _internal_read_lock() { _mtx_raw_access.lock_shared(); }
     void _internal_read_unlock() { _mtx_raw_access.unlock_shared(); }
+
+    uint64_t _internal_read_scalar() const noexcept { return _raw_scalar.load(std::memory_order_acquire); }
+
+    //! Copies trivially copyable raw data into dst, without any write to shared memory.
+    void _internal_read_sequenced(void* dst) const noexcept
+    {
+        for (;;) {
+            auto seq = _raw_sequence.load(std::memory_order_acquire);
+            if (seq & 1) { continue; }  // Writer is working on it
+
+            memcpy(dst, _body.trivial_data, _body.trivial_size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (_raw_sequence.load(std::memory_order_relaxed) == seq) { break; }
+        }
+    }
+
+   private:
+    //! Modify raw data. Every write to raw data must be done through this.
+    template <typename Fn>
+    void _modify_raw(Fn&& fn)
+    {
+        lock_guard _lc_{_mtx_raw_access};
+
+        _raw_sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        fn();
+
+        _raw_sequence.fetch_add(1, std::memory_order_release);
+        _publish_raw();
+    }
+
+    void _publish_raw() noexcept
+    {
+        if (_body.trivial_size == 0 || _body.trivial_size > sizeof(uint64_t)) { return; }
+
+        uint64_t value = 0;
+        memcpy(&value, _body.trivial_data, _body.trivial_size);
+        _raw_scalar.store(value, std::memory_order_release);
+    }
 };
 
 /*
@@ -254,10 +399,23 @@ class config_registry : public std::enable_shared_from_this<config_registry>
     //! If it's first call to creation, it'll register itself to global repository.
     bool update();
 
-    //! Export/Import
+    //! Opt-in. Queued changes will be applied promptly by background worker thread, without
+    //!  waiting for next update() call. Takes effect after registry is registered by first
+    //!  update() call.
+    void use_propagation_worker(bool enabled = true);
+
+    //! Begin atomic commit of multiple configs. See config_transaction.
+    config_transaction transaction(string_view source = "local");
+
+    //! Export/Import. Values are directly converted from/to json, and the buffer argument is
+    //!  not used anymore. It's left for source compatibility. Import skips configs bound to
+    //!  an environment variable which is set.
     void export_to(config_registry_storage_t* to, string* _ = nullptr) const;
     bool import_from(config_registry_storage_t const& from, string* _ = nullptr);
 
+    //! Remove entries which are identical with default value of corresponding config.
+    void strip_defaults(config_registry_storage_t* from) const;
+
     //! Touch this registry.
     //! Next check_update() will return
     void touch()
@@ -300,11 +458,19 @@ class config_registry : public std::enable_shared_from_this<config_registry>
     //! Event listener
     event<config_registry*>::frontend const on_update_notify;
 
+    //! Invoked inside update(), right after any change was applied.
+    event<config_registry*>::frontend const on_fence_update;
+
    public:
     bool _internal_commit_value_user(config_base* ref, refl::shared_object_ptr);
+    bool _internal_commit_batch(array_view<pair<config_base_ptr, refl::shared_object_ptr>> items, string_view source);
     bool _internal_commit_inplace_user(config_base* ref, refl::object_view_t view);
     void const* _internal_unique_address() { return this; }
 
+    //! Blocks update() of this registry while returned lock is held. Returns empty lock if
+    //!  called from inside update() of this registry, as it's already held by this thread.
+    std::unique_lock<std::mutex> _internal_lock_update();
+
     //! Called once after creation.
     //! Just for reservation ...
     void _internal_init_registry() { (void)0; }
@@ -329,6 +495,123 @@ class config_registry : public std::enable_shared_from_this<config_registry>
     void _internal_item_remove(config_base_wptr arg);
 };
 
+namespace _configs {
+/**
+ * Pool of staging objects for config<T>::commit.
+ *
+ * Each thread keeps its own free list, which is refilled from or spilled to the shared
+ *  free list in batches. As staged objects are released by the updating thread, objects
+ *  gathered there flow back to committing threads through the shared list.
+ */
+template <typename ValueType>
+class staging_pool
+{
+    using element_ptr = std::unique_ptr<ValueType>;
+
+    enum : size_t {
+        batch_size = 16,
+        local_capacity = batch_size * 4,
+    };
+
+    struct shared_list_t {
+        spinlock lock;
+        vector<element_ptr> free;
+    };
+
+    struct local_list_t {
+        vector<element_ptr> free;
+
+        ~local_list_t()
+        {
+            _local_expired() = true;
+
+            auto& shared = _shared();
+            CPPH_TMPVAR{std::lock_guard{shared.lock}};
+            std::move(free.begin(), free.end(), back_inserter(shared.free));
+        }
+    };
+
+   public:
+    static shared_ptr<ValueType> checkout()
+    {
+        ValueType* ptr = nullptr;
+
+        if (not _local_expired()) {
+            auto& local = _local();
+
+            if (local.free.empty()) {
+                auto& shared = _shared();
+                CPPH_TMPVAR{std::lock_guard{shared.lock}};
+
+                auto n = std::min<size_t>(shared.free.size(), batch_size);
+                std::move(shared.free.end() - n, shared.free.end(), back_inserter(local.free));
+                shared.free.erase(shared.free.end() - n, shared.free.end());
+            }
+
+            if (not local.free.empty()) {
+                ptr = local.free.back().release();
+                local.free.pop_back();
+            }
+        }
+
+        if (ptr == nullptr) { ptr = new ValueType{}; }
+        return shared_ptr<ValueType>{ptr, &_checkin};
+    }
+
+   private:
+    static void _checkin(ValueType* raw) noexcept
+    {
+        element_ptr ptr{raw};
+
+        // If list can't grow, object is simply deleted instead of being pooled.
+        try {
+            if (_local_expired()) {
+                // Thread is exiting; local list is not accessible anymore.
+                auto& shared = _shared();
+                CPPH_TMPVAR{std::lock_guard{shared.lock}};
+                shared.free.emplace_back(move(ptr));
+                return;
+            }
+
+            auto& local = _local();
+            local.free.emplace_back(move(ptr));
+
+            if (local.free.size() > local_capacity) {
+                auto& shared = _shared();
+                CPPH_TMPVAR{std::lock_guard{shared.lock}};
+
+                // Moving elements can't fail once storage is reserved.
+                shared.free.reserve(shared.free.size() + batch_size);
+
+                auto begin = local.free.end() - batch_size;
+                std::move(begin, local.free.end(), back_inserter(shared.free));
+                local.free.erase(begin, local.free.end());
+            }
+        } catch (std::bad_alloc&) {
+        }
+    }
+
+    static shared_list_t& _shared() noexcept
+    {
+        // Intentionally leaked, as staged objects can be released during static destruction.
+        static auto instance = new shared_list_t;
+        return *instance;
+    }
+
+    static local_list_t& _local() noexcept
+    {
+        thread_local local_list_t instance;
+        return instance;
+    }
+
+    static bool& _local_expired() noexcept
+    {
+        thread_local bool expired = false;
+        return expired;
+    }
+};
+}  // namespace _configs
+
 /**
  * 실제 사용자가 상호작용할 option 클래스
  *
@@ -347,6 +630,14 @@ class config
     ValueType const* _ref = nullptr;
     mutable size_t _update_check_fence = 0;
 
+    // Set if this instance is part of snapshot. Value accessors will return this.
+    shared_ptr<ValueType const> _frozen;
+
+    // Trivially copyable values can be read without lock.
+    static constexpr bool _is_trivial_read
+            = std::is_trivially_copyable_v<ValueType> && std::is_default_constructible_v<ValueType>;
+    static constexpr bool _is_scalar_read = _is_trivial_read && sizeof(ValueType) <= sizeof(uint64_t);
+
    public:
     config() noexcept = default;
     explicit config(config_attribute_ptr attrib) noexcept
@@ -362,6 +653,11 @@ class config
         init.attribute = move(attrib);
         init.raw_data = raw_data;
 
+        if constexpr (_is_trivial_read) {
+            init.trivial_data = raw_data.get();
+            init.trivial_size = sizeof(ValueType);
+        }
+
         _base = make_shared<config_base>(move(init));
     }
 
@@ -371,8 +667,7 @@ class config
         auto owner = _base->owner();
         assert(owner);
 
-        static pool<ValueType, spinlock> _pool;
-        auto ptr = _pool.checkout().share();
+        auto ptr = _configs::staging_pool<ValueType>::checkout();
         *ptr = move(val);
 
         return owner->_internal_commit_value_user(_base.get(), move(ptr));
@@ -393,13 +688,35 @@ class config
 
     ValueType value() const noexcept
     {
-        _base->_internal_read_lock();
-        ValueType value = *_ref;
-        _base->_internal_read_unlock();
+        if (_frozen) { return *_ref; }
+        return _live_value();
+    }
+
+   private:
+    ValueType _live_value() const noexcept
+    {
+        if constexpr (_is_scalar_read) {
+            auto scalar = _base->_internal_read_scalar();
+            ValueType value;
+            memcpy(&value, &scalar, sizeof value);
+
+            return value;
+        } else if constexpr (_is_trivial_read) {
+            ValueType value;
+            _base->_internal_read_sequenced(&value);
+
+            return value;
+        } else {
+            _base->_internal_read_lock();
+            ValueType value = *_ref;
+            _base->_internal_read_unlock();
 
-        return value;
+            return value;
+        }
     }
 
+   public:
+    //! Unsynchronized reference to underlying value. Use value() if there's any concurrent update.
     ValueType const& ref() const noexcept
     {
         return *_ref;
@@ -431,6 +748,27 @@ class config
         return _update_check_fence != _base->fence();
     }
 
+    /**
+     * Register typed callback, which is invoked with updated value on the thread that applied
+     *  the update. With propagation worker enabled, it's the worker thread.
+     */
+    template <typename Anchor, typename Fn, typename = enable_if_t<is_invocable_v<Fn, ValueType const&>>>
+    void on_update(Anchor&& anchor, Fn&& fn) const
+    {
+        assert(not _frozen && "Snapshot configs can't be subscribed!");
+
+        // Capturing config itself would make reference cycle.
+        _base->on_update.add_weak(
+                std::forward<Anchor>(anchor),
+                [ref = _ref, fn = std::forward<Fn>(fn)](config_base* base) {
+                    base->_internal_read_lock();
+                    ValueType value = *ref;
+                    base->_internal_read_unlock();
+
+                    fn(value);
+                });
+    }
+
    public:
     config_base_ptr base() const noexcept
     {
@@ -451,11 +789,181 @@ class config
     }
 
    public:
-    void const* _internal_unique_address() const { return _ref; }
+    void const* _internal_unique_address() const { return _base.get(); }
+
+    //! Detach value accessors from live value, with copy of current one.
+    void _internal_freeze()
+    {
+        _frozen = make_shared<ValueType const>(_live_value());
+        _ref = _frozen.get();
+    }
+};
+
+/**
+ * Value computed from one or more configs. Result is computed lazily on first read, and
+ *  recomputed only when any of dependencies' fence has changed since last computation.
+ *
+ * Computed result is published as immutable snapshot, thus reading up-to-date result
+ *  never waits for computation. Note that atomic access to shared_ptr is not lock-free on
+ *  most standard libraries. Recomputation is serialized, so concurrent readers observing
+ *  same change won't compute it redundantly.
+ *
+ * Copies share the same cache. Default constructed instance is empty, and must be assigned
+ *  before any access.
+ */
+template <typename ValueType>
+class derived_config
+{
+   public:
+    using value_type = ValueType;
+
+   private:
+    struct result_t {
+        size_t generation = 0;
+        vector<size_t> fences;
+        ValueType value;
+    };
+
+    struct state_t {
+        ufunction<ValueType()> fn_compute;
+        vector<config_base_ptr> dependencies;
+
+        std::mutex mtx_compute;
+        size_t generation = 0;
+        shared_ptr<result_t const> latest;
+    };
+
+    shared_ptr<state_t> _state;
+    mutable size_t _checked_generation = 0;
+
+   public:
+    derived_config() noexcept = default;
+
+    //! Returns false if this is default constructed.
+    bool is_valid() const noexcept { return _state != nullptr; }
+
+    template <typename Fn, typename... Deps,
+              typename = enable_if_t<std::is_invocable_r_v<ValueType, Fn, Deps const&...>>>
+    explicit derived_config(Fn&& fn, config<Deps> const&... deps)
+            : _state(make_shared<state_t>())
+    {
+        static_assert(sizeof...(Deps) > 0, "Derived config requires at least one dependency!");
+
+        _state->fn_compute = [fn = std::forward<Fn>(fn), deps...] { return fn(deps.value()...); };
+        _state->dependencies = {deps.base()...};
+    }
+
+   public:
+    //! Returns up-to-date result. Recomputes it if any of dependencies has changed.
+    shared_ptr<ValueType const> get() const
+    {
+        auto result = _up_to_date_result();
+        auto value = &result->value;
+        return {move(result), value};
+    }
+
+    ValueType value() const { return *get(); }
+
+    //! Returns true if result has been recomputed since last check.
+    bool check_update() const
+    {
+        auto generation = _up_to_date_result()->generation;
+        return exchange(_checked_generation, generation) != generation;
+    }
+
+   private:
+    shared_ptr<result_t const> _up_to_date_result() const
+    {
+        assert(_state && "Empty derived_config must not be accessed!");
+
+        auto result = std::atomic_load_explicit(&_state->latest, std::memory_order_acquire);
+        if (result && _is_up_to_date(*result)) { return result; }
+
+        CPPH_TMPVAR{std::lock_guard{_state->mtx_compute}};
+
+        // Other thread might already have done the work.
+        result = std::atomic_load_explicit(&_state->latest, std::memory_order_acquire);
+        if (result && _is_up_to_date(*result)) { return result; }
+
+        // Fences are sampled before reading values, thus any update during computation
+        //  makes the next read recompute again.
+        auto next = make_shared<result_t>();
+        next->generation = ++_state->generation;
+        next->fences.reserve(_state->dependencies.size());
+        for (auto& dep : _state->dependencies) { next->fences.push_back(dep->fence()); }
+        next->value = _state->fn_compute();
+
+        result = move(next);
+        std::atomic_store_explicit(&_state->latest, result, std::memory_order_release);
+        return result;
+    }
+
+    bool _is_up_to_date(result_t const& result) const noexcept
+    {
+        for (size_t i = 0; i < result.fences.size(); ++i)
+            if (_state->dependencies[i]->fence() != result.fences[i])
+                return false;
+
+        return true;
+    }
+};
+
+/**
+ * Stages values of multiple configs in same registry, then commits them at once.
+ *
+ * On commit(), every staged value is validated first. If any of them fails, nothing will
+ *  be applied. Otherwise, all values become visible within the same update() call.
+ */
+class config_transaction
+{
+    config_registry_ptr _rg;
+    vector<pair<config_base_ptr, refl::shared_object_ptr>> _items;
+    string_view _source;
+    bool _failed = false;
+
+   public:
+    //! Source describes where the changes came from, in history. Must have static lifetime.
+    explicit config_transaction(config_registry_ptr rg, string_view source = "local") noexcept
+            : _rg(move(rg)), _source(source) {}
+
+   public:
+    //! Value type is deduced only from config, thus e.g. literal 1 can be staged to config<double>.
+    template <typename ValueType>
+    config_transaction& set(config<ValueType> const& conf, _configs::type_identity_t<ValueType> value)
+    {
+        if constexpr (std::is_default_constructible_v<ValueType>) {
+            auto ptr = _configs::staging_pool<ValueType>::checkout();
+            *ptr = move(value);
+
+            return stage(conf.base(), refl::shared_object_ptr{move(ptr)});
+        } else {
+            return stage(conf.base(), refl::shared_object_ptr{make_shared<ValueType>(move(value))});
+        }
+    }
+
+    //! Stage type-erased value. Config must be owned by this transaction's registry.
+    config_transaction& stage(config_base_ptr conf, refl::shared_object_ptr value)
+    {
+        if (conf->owner() != _rg)
+            _failed = true;
+        else
+            _items.emplace_back(move(conf), move(value));
+
+        return *this;
+    }
+
+    //! Stage value from serialized content. Parse failure makes whole transaction fail.
+    config_transaction& stage(config_id_t id, archive::if_reader* content);
+
+    //! Returns false if any of the staged values was rejected. Transaction is reset after call.
+    bool commit();
+
+    size_t size() const noexcept { return _items.size(); }
+    bool empty() const noexcept { return _items.empty(); }
 };
 
 namespace _configs {
-void parse_full_key(string const& full_key, string* o_display_key, vector<string_view>* o_hierarchy);
+void parse_full_key(string_view full_key, string* o_display_key, vector<string_view>* o_hierarchy);
 void verify_flag_string(string_view str);
 }  // namespace _configs
 }  // namespace perfkit::v2
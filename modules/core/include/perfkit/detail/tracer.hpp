@@ -28,6 +28,7 @@
 #pragma once
 #include <atomic>
 #include <chrono>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <optional>
@@ -51,8 +52,17 @@ class tracer;
 
 using std::chrono::steady_clock;
 using std::chrono::system_clock;
+
+/**
+ * Array payload is shared as immutable buffer, thus fetching traces never copies array
+ *  content. Tracer reuses the buffer on next assignment only if no one else refers to it.
+ */
+template <typename Elem_>
+using trace_array = std::shared_ptr<std::vector<Elem_> const>;
+
 using trace_variant_type = std::variant<
-        nullptr_t, steady_clock::duration, int64_t, double, std::string, bool>;
+        nullptr_t, steady_clock::duration, int64_t, double, std::string, bool,
+        trace_array<double>, trace_array<int64_t>>;
 
 using trace_key_t = basic_key<class tracer>;
 
@@ -99,6 +109,10 @@ struct trace {
 
     trace_variant_type data;
 
+    // Timing analysis of timer nodes, calculated on every fetch.
+    steady_clock::duration self_time = {};  // Inclusive time minus children's inclusive time
+    bool on_critical_path = false;          // Heaviest chain of timers in iteration
+
    private:
     friend class ::perfkit::tracer;
     std::atomic_bool* _is_subscribed = {};
@@ -113,12 +127,40 @@ struct _entity_ty {
     std::atomic_bool is_subscribed{false};
     std::atomic_bool is_folded{false};
     _entity_ty const* parent = nullptr;
+
+    // Fence of latest timer write. Used by continuous mode to accumulate durations.
+    size_t fence_accumulated = 0;
+
+    // Scratch values for timing analysis
+    mutable steady_clock::duration children_time = {};
+    mutable _entity_ty const* heaviest_child = nullptr;
 };
+
+class process_view;
+class stall_watchdog;
 }  // namespace _trace
 
+/**
+ * Describes a tracer which didn't fork() within its stall deadline.
+ */
+struct tracer_stall_info {
+    steady_clock::duration elapsed = {};  // Time since latest fork()
+    std::vector<std::string> scope_path;   // Scopes that were open on stalled thread
+    std::vector<std::string> stack_trace;  // Call stack of stalled thread, if captured
+};
+
 template <typename Ty_, class = void>
 constexpr bool is_duration_v = false;
 
+template <typename Ty_, class = void>
+constexpr bool is_numeric_array_v = false;
+
+template <typename Ty_>
+constexpr bool is_numeric_array_v<
+        Ty_, std::void_t<decltype(std::data(std::declval<Ty_&>())),
+                         decltype(std::size(std::declval<Ty_&>()))>>
+        = std::is_arithmetic_v<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<Ty_&>()))>>>;
+
 template <typename Ty_>
 constexpr bool is_duration_v<
         Ty_, std::void_t<decltype(std::chrono::duration_cast<steady_clock::duration>(
@@ -162,6 +204,28 @@ class tracer_proxy
 
     auto& _string() noexcept { return _data_as<std::string>(); }
 
+    template <typename Elem_, typename Range_>
+    void _assign_array(Range_ const& range)
+    {
+        auto& slot = _data_as<trace_array<Elem_>>();
+        std::vector<Elem_>* dst;
+
+        // Fetched traces are only copied on the working thread, thus the buffer can't get
+        //  new owner meanwhile. Fence orders previous owners' reads before overwriting.
+        if (slot && slot.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            dst = const_cast<std::vector<Elem_>*>(slot.get());
+        } else {
+            auto buffer = std::make_shared<std::vector<Elem_>>();
+            dst = buffer.get();
+            slot = std::move(buffer);
+        }
+
+        auto src = std::data(range);
+        dst->resize(std::size(range));
+        for (size_t i = 0; i < dst->size(); ++i) { (*dst)[i] = static_cast<Elem_>(src[i]); }
+    }
+
    public:
     template <typename Str_, typename... Args_>
     tracer_proxy& operator()(Str_&& fmt, Args_&&... args)
@@ -176,7 +240,7 @@ class tracer_proxy
 
     template <typename Other_,
               typename = std::enable_if_t<not std::is_convertible_v<Other_, tracer_proxy>>>
-    tracer_proxy& operator=(Other_&& oty) noexcept
+    tracer_proxy& operator=(Other_&& oty)
     {
         if (not is_valid())
             return *this;
@@ -195,6 +259,13 @@ class tracer_proxy
             _string() = static_cast<std::string>(std::forward<Other_>(oty));
         } else if constexpr (is_duration_v<other_t>) {
             _data() = std::chrono::duration_cast<steady_clock::duration>(oty);
+        } else if constexpr (is_numeric_array_v<other_t>) {
+            using elem_t = std::remove_cv_t<std::remove_pointer_t<decltype(std::data(oty))>>;
+
+            if constexpr (std::is_floating_point_v<elem_t>)
+                _assign_array<double>(oty);
+            else
+                _assign_array<int64_t>(oty);
         }
         return *this;
     }
@@ -205,10 +276,12 @@ class tracer_proxy
         _owner = other._owner;
         _ref = other._ref;
         _epoch_if_required = other._epoch_if_required;
+        _is_iteration_root = other._is_iteration_root;
 
         other._owner = {};
         other._ref = {};
         other._epoch_if_required = {};
+        other._is_iteration_root = false;
 
         return *this;
     }
@@ -238,6 +311,7 @@ class tracer_proxy
     tracer* _owner = nullptr;
     _trace::_entity_ty* _ref = nullptr;
     steady_clock::time_point _epoch_if_required = {};
+    bool _is_iteration_root = false;  // Returned from fork(), keeps iteration open
 };
 
 class tracer : public std::enable_shared_from_this<tracer>
@@ -253,8 +327,15 @@ class tracer : public std::enable_shared_from_this<tracer>
     static_assert(std::is_nothrow_move_assignable_v<_trace::trace>);
     static_assert(std::is_nothrow_move_constructible_v<_trace::trace>);
 
+    enum class merge_mode {
+        sum,         // Sum of per-thread latest values
+        percentile,  // Percentile of per-thread latest values
+    };
+
    private:
     friend class tracer_proxy;
+    friend class _trace::process_view;
+    friend class _trace::stall_watchdog;
 
     // 0. fork가 호출되면 시퀀스 번호가 1 증가
     // 1. 새로운 문자열로 프록시 최초 생성 시 고정 슬롯 할당.
@@ -273,12 +354,35 @@ class tracer : public std::enable_shared_from_this<tracer>
     std::string const _name;
 
     std::vector<_entity_ty const*> _stack;
-    steady_clock::time_point _last_fork;
+
+    // Bottom of _stack, which can safely be read from signal handler of working thread.
+    _entity_ty const* _stack_mirror[32] = {};
+    std::atomic_int _stack_mirror_size = 0;
+    std::atomic<steady_clock::time_point> _last_fork = {};
     steady_clock::time_point _birth = steady_clock::now();
 
     std::thread::id _working_thread_id = {};
     std::atomic_bool _destroied = false;
 
+    // Continuous mode states
+    bool _is_continuous = false;
+    bool _is_thread_local = false;
+    steady_clock::time_point _last_flush;
+
+    // Stall watchdog states
+    std::atomic<steady_clock::rep> _stall_deadline = 0;
+    steady_clock::time_point _stall_reported_fork;  // Only accessed from watchdog
+
+    // Number of alive root proxies. Working thread is signalled only while it's nonzero,
+    //  thus the thread can't exit or be joined in the middle of signalling.
+    spinlock _iteration_lock;
+    int _open_iterations = 0;
+    uint64_t _working_thread_native = 0;
+
+    std::atomic_bool _has_stall_report = false;
+    spinlock _stall_report_lock;
+    std::string _stall_report;
+
    public:
     // Provides fetching interface
     class trace_fetch_proxy
@@ -329,11 +433,42 @@ class tracer : public std::enable_shared_from_this<tracer>
     static auto create(std::string_view name) { return create(0, name); }
     static auto all() noexcept -> std::vector<std::shared_ptr<tracer>>;
 
+    /**
+     * Immutable list of registered tracers sorted by order. Every create/unregister publishes
+     *  new copy of the list, thus readers never wait for registry mutation. Note that atomic
+     *  access to shared_ptr is not lock-free on most standard libraries (e.g. libstdc++ uses
+     *  a pool of mutexes), and is deprecated since C++20 in favor of atomic<shared_ptr>.
+     */
+    using registry_snapshot = std::shared_ptr<std::vector<std::weak_ptr<tracer>> const>;
+    static auto all_snapshot() noexcept -> registry_snapshot;
+
+    /**
+     * Tracer bound to calling thread. Lazily created on first call.
+     *
+     * Thread tracers are not listed on all(). Instead, their contents are merged into
+     *  single process-wide view named "[process]", on every continuous-mode flush.
+     */
+    static tracer& this_thread();
+
+    /**
+     * Set name of calling thread's tracer. Only takes effect before first this_thread() call.
+     * If not specified, platform thread name is used.
+     */
+    static void this_thread_name(std::string_view name);
+
+    /**
+     * Configure how identical paths from different threads are merged in process view.
+     */
+    static void process_view_merge_mode(merge_mode mode, double percentile = 0.5);
+
    public:
     static event<tracer*>& on_new_tracer();
     event<tracer*> on_destroy;
     event<trace_fetch_proxy> on_fetch;
 
+    //! Invoked from watchdog thread, when fork() didn't occur within stall deadline.
+    event<tracer_stall_info const&> on_stall;
+
    public:
     /**
      * Destroy this tracer explicitly.
@@ -357,6 +492,24 @@ class tracer : public std::enable_shared_from_this<tracer>
      */
     tracer_proxy fork(std::string_view n = "all", size_t interval = 0);
 
+    /**
+     * Fork in continuous mode.
+     *
+     * @details
+     *    Intended for code paths which don't have explicit loop, e.g. asio handlers or
+     *    thread pool tasks. Every invocation reopens root trace without increasing sequence
+     *    number, and timers accumulate their durations until the iteration is flushed.
+     *    Iteration is flushed only when `flush_interval` elapsed since the latest flush.
+     *
+     * @param n
+     *    Name of root trace.
+     * @param flush_interval
+     *    Minimum duration between two flushes.
+     */
+    tracer_proxy fork_continuous(
+            std::string_view n = "all",
+            steady_clock::duration flush_interval = std::chrono::seconds{1});
+
     /**
      * Create new timer branch from the topmost trace stack
      *
@@ -381,6 +534,19 @@ class tracer : public std::enable_shared_from_this<tracer>
         return br;
     }
 
+    /**
+     * Enable stall watchdog for this tracer.
+     *
+     * @details
+     *    If next fork() doesn't occur within given deadline while the proxy returned from
+     *    latest fork() is still alive, watchdog thread captures call stack of the forked
+     *    thread and currently open scopes, then reports them through log and on_stall
+     *    event. Latest report also appears in summary of next iteration.
+     *
+     * @param deadline Zero or negative value disables watchdog.
+     */
+    void stall_deadline(steady_clock::duration deadline);
+
     /**
      * Reserves for async data sort
      */
@@ -401,11 +567,16 @@ class tracer : public std::enable_shared_from_this<tracer>
    private:
     uint64_t _hash_active(_trace::_entity_ty const* parent, std::string_view top);
     bool _deliver_previous_result();
+    void _analyze_timings();
 
     // Create new or find existing.
     _trace::_entity_ty* _fork_branch(_trace::_entity_ty const* parent, std::string_view name, bool initial_subscribe_state);
-    static std::vector<std::weak_ptr<tracer>>& _all() noexcept;
+    static registry_snapshot& _registry() noexcept;
     void _try_pop(_trace::_entity_ty const* body);
+    void _sync_stack_mirror(size_t from) noexcept;
+
+    void _open_iteration(tracer_proxy* root) noexcept;
+    void _close_iteration() noexcept;
 };
 
 using tracer_ptr = std::shared_ptr<tracer>;
@@ -426,4 +597,11 @@ using tracer_wptr = std::weak_ptr<tracer>;
  */
 void sort_messages_by_rule(tracer::fetched_traces&) noexcept;
 
+/**
+ * Dump timer nodes as folded stacks, which can be directly consumed by flame graph tools.
+ *
+ * Each line is formatted as `root;child;grandchild <self time in microseconds>`.
+ */
+void dump_folded_stacks(tracer::fetched_traces const&, std::string* out);
+
 }  // namespace perfkit
@@ -191,6 +191,32 @@ void register_conffile_io_commands(
         std::string_view cmd_store = "save-config",
         std::string_view initial_path = {});  // e.g. "w"
 
+/**
+ * Register configuration file watch command
+ *
+ * @param ref
+ * @param cmd usage: cmd [path]. Starts reloading configs on every change of given file.
+ *            If path is not specified, stops watching.
+ */
+void register_conffile_watch_command(
+        if_terminal* ref,
+        std::string_view cmd = "watch-config");
+
+/**
+ * Register configuration change history command
+ *
+ * @param ref
+ * @param cmd
+ *
+ * @details
+ *
+ *      <cmd> <registry>: lists recorded changes of registry, oldest first
+ *      <cmd> <registry> rollback <fence>: restores every config changed after given fence
+ */
+void register_config_history_command(
+        if_terminal* ref,
+        std::string_view cmd = "config-history");
+
 /**
  * Register option manipulation command
  *
@@ -26,86 +26,285 @@
 
 #include "perfkit/detail/configs-v2-flags.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <unordered_map>
 
+#include "configs-v2-json.hpp"
 #include "cpph/refl/core.hxx"
 #include "cpph/refl/detail/if_archive.hxx"
 #include "perfkit/detail/configs-v2-backend.hpp"
 
+using namespace std::literals;
+
 namespace perfkit::v2 {
-// TODO: Define archive::flag_reader, which parses newline-separated flag variables
+/**
+ * Reads value directly from argument string, without copying it. Arrays are given as
+ *  comma separated list of elements.
+ */
 class flag_reader : public archive::if_reader
 {
+    string_view _value;
+    size_t _pos = 0;
+    bool _is_array = false;
+    bool _consumed = false;
+
    public:
-    explicit flag_reader(std::streambuf* buf) noexcept : if_reader(buf) {}
+    explicit flag_reader(string_view value) noexcept : if_reader(nullptr), _value(value) {}
 
    public:
-    if_reader& read(nullptr_t a_nullptr) override
+    if_reader& read(nullptr_t) override
     {
-        // TODO
-        return *this;
+        return _take(), *this;
     }
+
     if_reader& read(bool& v) override
     {
-        // TODO
-        return if_reader::read(v);
+        auto token = _take();
+
+        if (token == "true" || token == "1" || token == "yes" || token == "on")
+            v = true;
+        else if (token == "false" || token == "0" || token == "no" || token == "off")
+            v = false;
+        else
+            _throw_invalid(token, "boolean");
+
+        return *this;
     }
+
     if_reader& read(int64_t& v) override
     {
-        // TODO
+        auto token = _take();
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), v);
+        if (ec != std::errc{} || ptr != token.data() + token.size()) { _throw_invalid(token, "integer"); }
+
         return *this;
     }
+
     if_reader& read(double& v) override
     {
-        // TODO
+        auto token = _take();
+
+        // Token is not null-terminated if it's part of array.
+        char buf[64];
+        if (token.empty() || token.size() >= sizeof buf) { _throw_invalid(token, "number"); }
+
+        *std::copy(token.begin(), token.end(), buf) = 0;
+
+        char* end = nullptr;
+        v = std::strtod(buf, &end);
+        if (end != buf + token.size()) { _throw_invalid(token, "number"); }
+
         return *this;
     }
+
     if_reader& read(string& v) override
     {
-        // TODO
+        auto token = _take();
+        v.assign(token.begin(), token.end());
         return *this;
     }
 
+    archive::context_key begin_array() override
+    {
+        if (_is_array) { _throw_no_support(); }  // Nested array is not allowed
+        _is_array = true;
+        return {1};
+    }
+
+    void end_array(archive::context_key) override { _is_array = false; }
+
+    bool should_break(const archive::context_key&) const override
+    {
+        return _pos >= _value.size();
+    }
+
+    archive::entity_type type_next() const override
+    {
+        using archive::entity_type;
+
+        if (_is_array ? _pos >= _value.size() : _consumed) { return entity_type::invalid; }
+        auto token = _peek();
+
+        if (token == "true" || token == "false") { return entity_type::boolean; }
+
+        int64_t i;
+        if (auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), i);
+            ec == std::errc{} && ptr == token.data() + token.size()) {
+            return entity_type::integer;
+        }
+
+        return entity_type::string;
+    }
+
     archive::context_key begin_object() override { _throw_no_support(); }
-    void end_array(archive::context_key key) override { _throw_no_support(); }
-    void read_key_next() override { _throw_no_support(); }
     void end_object(archive::context_key key) override { _throw_no_support(); }
-    void end_binary() override { _throw_no_support(); }
+    void read_key_next() override { _throw_no_support(); }
     size_t begin_binary() override { _throw_no_support(); }
     size_t binary_read_some(mutable_buffer_view v) override { _throw_no_support(); }
+    void end_binary() override { _throw_no_support(); }
 
-    archive::context_key begin_array() override
+   private:
+    string_view _peek() const noexcept
     {
-        return {1};
+        if (not _is_array) { return _value; }
+
+        auto rest = _value.substr(_pos);
+        return rest.substr(0, rest.find(','));
     }
 
-    bool should_break(const archive::context_key& key) const override
+    string_view _take()
     {
-        return _buf->sgetc() == EOF;
+        if (not _is_array) {
+            if (exchange(_consumed, true)) { throw std::runtime_error{"flag value already consumed"}; }
+            return _value;
+        }
+
+        auto token = _peek();
+        _pos += token.size() + 1;  // Skip comma as well
+        return token;
     }
 
-    archive::entity_type type_next() const override
+    [[noreturn]] static void _throw_invalid(string_view token, char const* expected)
     {
-        return archive::entity_type::string;
+        throw std::runtime_error{"'" + string{token} + "' is not a valid " + expected};
     }
 
-   private:
-    [[noreturn]] void _throw_no_support()
+    [[noreturn]] static void _throw_no_support()
     {
         throw std::logic_error{"Flag must be bound to {boolean|number|string|array<boolean|number|string>}"};
     }
 };
 
-// Meaningless character sequence to identify internal flag value
-#define FLAG_ESCAPE   "$c`|*;2^n0"
-#define FLAG_ESCAPE_N (sizeof(FLAG_ESCAPE) - 1)
+namespace {
+struct flag_entry {
+    string_view name;
+    config_registry* registry;
+    config_base* config;
+    bool is_boolean;
+};
 
-using collected_flag_binding_t = map<string_view, pair<config_registry*, config_base_ptr>>;
+/**
+ * Lookup table of all flag bindings, which is built once per parse. Long flags are
+ *  binary-searched from sorted array, and single character flags are directly indexed.
+ */
+class flag_table
+{
+    vector<config_base_ptr> _anchors;
+    vector<flag_entry> _entries;
+    std::array<flag_entry const*, 128> _short = {};
 
-[[noreturn]] static void throw_help_string(collected_flag_binding_t const& bindings)
+   public:
+    void build(array_view<config_registry_ptr> regs, bool allow_duplication)
+    {
+        for (auto& rg : regs) {
+            auto begin = _anchors.size();
+            rg->backend()->bk_all_items(&_anchors);
+
+            for (auto index = begin; index < _anchors.size(); ++index) {
+                auto& item = _anchors[index];
+                auto meta = item->attribute()->default_value.view().meta;
+                bool is_boolean = meta->type() == archive::entity_type::boolean;
+
+                for (auto& binding : item->attribute()->flag_bindings)
+                    _entries.push_back({binding, rg.get(), item.get(), is_boolean});
+            }
+        }
+
+        // Stable sort keeps the first binding among duplicated ones at front.
+        std::stable_sort(_entries.begin(), _entries.end(),
+                         [](auto& a, auto& b) { return a.name < b.name; });
+
+        auto iter_dup = std::adjacent_find(_entries.begin(), _entries.end(),
+                                           [](auto& a, auto& b) { return a.name == b.name; });
+
+        if (iter_dup != _entries.end()) {
+            if (not allow_duplication)
+                throw std::logic_error{"Flag binding duplication: " + string{iter_dup->name}};
+
+            auto fn_same_name = [](auto& a, auto& b) { return a.name == b.name; };
+            _entries.erase(std::unique(_entries.begin(), _entries.end(), fn_same_name), _entries.end());
+        }
+
+        for (auto& entry : _entries)
+            if (entry.name.size() == 1 && uint8_t(entry.name[0]) < _short.size())
+                _short[entry.name[0]] = &entry;
+    }
+
+    flag_entry const* find(string_view name) const noexcept
+    {
+        if (name.size() == 1) { return find(name[0]); }
+
+        auto iter = std::lower_bound(_entries.begin(), _entries.end(), name,
+                                     [](auto& e, auto& key) { return e.name < key; });
+
+        return iter != _entries.end() && iter->name == name ? &*iter : nullptr;
+    }
+
+    flag_entry const* find(char ch) const noexcept
+    {
+        return uint8_t(ch) < _short.size() ? _short[ch] : nullptr;
+    }
+
+    auto const& entries() const noexcept { return _entries; }
+};
+
+string build_help_string(flag_table const& table)
 {
-    throw std::exception{};  // TODO
+    // Gather flags by config, in registry and declaration order.
+    vector<config_base*> configs;
+    std::unordered_map<config_base*, vector<string_view>> names;
+
+    for (auto& entry : table.entries()) {
+        auto [iter, is_new] = names.try_emplace(entry.config);
+        if (is_new) { configs.push_back(entry.config); }
+
+        iter->second.push_back(entry.name);
+    }
+
+    string help = "Options:\n";
+    _configs::json_dom_writer writer;
+    nlohmann::json default_value;
+
+    for (auto config : configs) {
+        auto& flags = names[config];
+        std::sort(flags.begin(), flags.end(), [](auto& a, auto& b) { return a.size() < b.size(); });
+
+        auto line_begin = help.size();
+        help += "  ";
+
+        for (auto& flag : flags) {
+            help.append(flag.size() == 1 ? "-" : "--").append(flag);
+            if (&flag != &flags.back()) { help += ", "; }
+        }
+
+        auto attr = config->attribute();
+        auto is_boolean = attr->default_value.view().meta->type() == archive::entity_type::boolean;
+        if (not is_boolean) { help += " <value>"; }
+
+        // Align descriptions
+        auto width = help.size() - line_begin;
+        help.append(width < 32 ? 32 - width : 1, ' ');
+
+        help += config->full_key();
+        if (not attr->description.empty()) { help.append(": ").append(attr->description); }
+
+        try {
+            writer.reset(&default_value);
+            writer << attr->default_value.view();
+            help.append(" (default: ").append(default_value.dump()).append(")");
+        } catch (std::exception&) {
+            // Default value is optional on help string.
+        }
+
+        help += '\n';
+    }
+
+    return help;
 }
+}  // namespace
 
 void configs_parse_args(int& ref_argc, char const**& ref_argv, config_parse_arg_option option, array_view<config_registry_ptr> regs)
 {
@@ -121,118 +320,172 @@ void configs_parse_args(int& ref_argc, char const**& ref_argv, config_parse_arg_
             for (auto& rg : regs) { rg->update(); }
     }
 
-    // Collect all flag bindings from 'regs'
-    collected_flag_binding_t flag_bindings;
-    map<config_base*, pair<config_registry*, std::stringbuf>> flag_payloads;
+    flag_table table;
+    table.build(regs, option.allow_flag_duplication);
 
-    vector<config_base_ptr> all_items;
-    for (auto& rg : regs) {
-        all_items.clear();
-        rg->backend()->bk_all_items(&all_items);
+    // Values refer to argv directly, or to literal for boolean flags. Latest one wins, among
+    //  every flag bound to same config. Flag token is kept as given, for error messages.
+    struct flag_value {
+        flag_entry const* entry;
+        string_view value;
+        string_view token;
+    };
 
-        for (auto& item : all_items) {
-            auto& bindings = item->attribute()->flag_bindings;
-            if (bindings.empty()) { continue; }
+    std::unordered_map<config_base*, flag_value> values;
+    values.reserve(ref_argc);
 
-            for (auto& binding : bindings) {
-                if (
-                        not flag_bindings.try_emplace(binding, pair{rg.get(), item}).second
-                        &&                                 //
-                        not option.allow_flag_duplication  //
-                ) {
-                    throw std::logic_error{"Flag binding duplication!"};
-                }
-            }
-        }
-    }
+    auto fn_set = [&](flag_entry const* entry, string_view value, string_view token) {
+        values.insert_or_assign(entry->config, flag_value{entry, value, token});
+    };
 
-    // Helpers
     auto fn_is_w = [](auto c) { return isalnum(c) || c == '-' || c == '_'; };
+    auto fn_bool_str = [](bool v) { return v ? "true"sv : "false"sv; };
+    auto fn_unknown = [&](string_view flag) {
+        if (not option.allow_unknown_flag)
+            throw std::runtime_error{"Unknown flag '" + string{flag} + "'"};
+    };
+
+    char const** const p_begin = ref_argv + int(option.is_first_arg_exec_name);
+    char const** const p_end = ref_argv + ref_argc;
+
+    // argv is left untouched unless flags should be consumed.
+    vector<bool> consumed(ref_argc);
+    auto fn_consume = [&](char const** p_arg) { consumed[p_arg - ref_argv] = true; };
+    auto fn_is_consumed = [&](char const** p_arg) -> bool { return consumed[p_arg - ref_argv]; };
+
+    // Retrieves value from next argument, which must not be a flag.
+    auto fn_next_value = [&](char const** p_arg, string_view flag) -> string_view {
+        auto p_next = p_arg + 1;
+        if (p_next >= p_end || fn_is_consumed(p_next)) {
+            throw std::runtime_error{"Missing value for flag '" + string{flag} + "'"};
+        }
+
+        string_view next = *p_next;
+        if (next.size() > 1 && next[0] == '-' && not isdigit(next[1]) && next[1] != '.') {
+            throw std::runtime_error{"Missing value for flag '" + string{flag} + "', got flag '" + string{next} + "'"};
+        }
+
+        fn_consume(p_next);
+        return next;
+    };
 
     // Iterate arguments
-    for (char const **p_arg = ref_argv + int(option.is_first_arg_exec_name),
-                    **p_end = ref_argv + ref_argc;
-         p_arg < p_end;) {
+    for (char const** p_arg = p_begin; p_arg < p_end; ++p_arg) {
+        if (fn_is_consumed(p_arg)) { continue; }  // Consumed as value of previous flag
+
         string_view arg = *p_arg;
 
-        if (arg == "--")
+        if (arg == "--") {
+            fn_consume(p_arg);
             break;  // Stop parsing on '--'
+        }
 
-        if (arg[0] == '-' && arg[1] == '-' && arg[2] != '-') {
+        if (arg.size() > 2 && arg[0] == '-' && arg[1] == '-' && arg[2] != '-') {
             // If flag is prefixed with '--'
-            string_view key = arg.substr(2);  // after '--'
-            string_view value;
-
+            string_view key = arg.substr(2);
             auto dividx = find_if_not(key, fn_is_w) - key.begin();
-            bool is_no_prefixed = false;
-            value = key.substr(dividx);
+            string_view value = key.substr(dividx);
             key = key.substr(0, dividx);
 
-            if (key == "help") {
-                // - If flag equals 'help', construct help string from regs and throw.
-                throw_help_string(flag_bindings);
-            } else if (key.find("no-") == 0) {
-                // - If flag starts with 'no-', parse rest as boolean key, and store '>>~~$false$~<<'
+            bool has_value = not value.empty();
+            if (has_value && value[0] != '=') { throw std::runtime_error{"Invalid flag '" + string{arg} + "'"}; }
+            if (has_value) { value = value.substr(1); }
+
+            auto token = arg.substr(0, 2 + key.size());
+
+            if (key == "help" && not table.find(key)) { throw configs_parse_help_exception{build_help_string(table)}; }
+
+            bool is_no_prefixed = false;
+            auto entry = table.find(key);
+
+            if (not entry && key.find("no-") == 0) {
                 is_no_prefixed = true;
-                key = key.substr(3);  // Remove initial 'no-' prefix
+                entry = table.find(key.substr(3));
             }
 
-            auto binding = find_ptr(flag_bindings, key);
-            if (not binding) {
-                if (not option.allow_unknown_flag)
-                    throw std::runtime_error{"Unknown flag: " + string{key}};
-
+            if (not entry) {
+                fn_unknown(arg);
                 continue;
             }
 
-            // Retrieve type metadata
-            auto& [reg, cfg] = binding->second;
-            auto metadata = cfg->attribute()->default_value.view().meta;
-            if (metadata->type() == archive::entity_type::boolean) {
-                // - If flag binding is boolean, store '>>~~$true$~~<<'
-                auto& [rg, payload] = flag_payloads[cfg.get()];
-
-                if (is_no_prefixed) {
-                    rg = reg, payload.sputn(FLAG_ESCAPE "false", FLAG_ESCAPE_N + 5);
-                } else {
-                    rg = reg, payload.sputn(FLAG_ESCAPE "true", FLAG_ESCAPE_N + 4);
-                }
+            if (entry->is_boolean) {
+                if (is_no_prefixed && has_value)
+                    throw std::runtime_error{"'" + string{arg} + "': 'no-' prefixed flag can't have value!"};
+
+                fn_set(entry, has_value ? value : fn_bool_str(not is_no_prefixed), token);
             } else {
-                if (is_no_prefixed) {
-                    throw std::runtime_error{string{key} + ": 'no-' prefix is not allowed on non-boolean flag!"};
-                }
-
-                // - It's just value ...
-                //   If value is already found(was single argument), just use it.
-                //   Otherwise, step p_arg. In this case, next p_arg *must* not be flag!
-                // TODO
+                if (is_no_prefixed)
+                    throw std::runtime_error{"'" + string{token} + "': 'no-' prefix is not allowed on non-boolean flag!"};
+
+                fn_set(entry, has_value ? value : fn_next_value(p_arg, token), token);
             }
-        } else if (arg[0] == '-' && arg[1] != '-') {
+
+            fn_consume(p_arg);
+        } else if (arg.size() > 1 && arg[0] == '-' && arg[1] != '-') {
             // If flag is prefixed with '-'
-            // - If first character is 'h', construct help string from regs and throw.
-            // - If first character is non-boolean flag: Parse rest as value
-            // - If first character is boolean flag: Treat all chars as boolean flag.
-            // TODO:
-        } else {
-            continue;
+            //  -abc : Each character is boolean flag.
+            //  -Nabc: Each character is boolean flag, which is set false.
+            //  -xVALUE, -x VALUE: If first character is non-boolean flag, rest is value.
+            auto chars = arg.substr(1);
+
+            if (chars == "h" && not table.find('h')) { throw configs_parse_help_exception{build_help_string(table)}; }
+
+            if (auto entry = table.find(chars[0]); entry && not entry->is_boolean) {
+                auto token = arg.substr(0, 2);
+                fn_set(entry, chars.size() > 1 ? chars.substr(1) : fn_next_value(p_arg, token), token);
+                fn_consume(p_arg);
+                continue;
+            }
+
+            bool value = true;
+            if (chars[0] == 'N' && not table.find('N')) {
+                value = false;
+                chars = chars.substr(1);
+            }
+
+            // Validate all before applying any, as unknown group is left untouched.
+            bool has_unknown = chars.empty();
+            for (auto ch : chars) {
+                auto entry = table.find(ch);
+
+                if (entry && not entry->is_boolean)
+                    throw std::runtime_error{"Non-boolean flag '" + string(1, ch) + "' in group '" + string{arg} + "'"};
+
+                has_unknown |= entry == nullptr;
+            }
+
+            if (has_unknown) {
+                fn_unknown(arg);
+                continue;
+            }
+
+            for (auto ch : chars) { fn_set(table.find(ch), fn_bool_str(value), arg); }
+            fn_consume(p_arg);
         }
     }
 
-    // Perform actual parsing
-    for (auto& [cfg, pair] : flag_payloads) {
-        auto& [reg, payload] = pair;
-
-        flag_reader rd{&payload};
-        if (not reg->backend()->bk_commit(cfg, &rd)) {
-            // TODO: Throw error string
+    // Perform actual parsing. Values are committed as they are, thus registry update is
+    //  required to make them visible.
+    for (auto& [config, flag] : values) {
+        auto& [entry, value, token] = flag;
+        flag_reader rd{value};
+
+        try {
+            if (not entry->registry->backend()->bk_commit(entry->config, &rd, {}, "args"))
+                throw std::runtime_error{"rejected by validator"};
+        } catch (std::exception& e) {
+            throw std::runtime_error{
+                    "Invalid value '" + string{value} + "' for flag '" + string{token} + "': " + e.what()};
         }
     }
 
     if (option.consume_flags) {
-        // Erase all consumed flags from argv
-        array_view argv{ref_argv, size_t(ref_argc)};
-        auto iter = stable_partition(argv, [](auto p) { return p != nullptr; });
-        ref_argc = iter - argv.begin();
+        // Erase all consumed flags from argv, keeping order of the others.
+        int num_left = 0;
+        for (int i = 0; i < ref_argc; ++i)
+            if (not consumed[i]) { ref_argv[num_left++] = ref_argv[i]; }
+
+        ref_argc = num_left;
     }
 }
 }  // namespace perfkit::v2
@@ -0,0 +1,283 @@
+/*******************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2022. Seungwoo Kang
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * project home: https://github.com/perfkitpp
+ ******************************************************************************/
+
+#pragma once
+#include <nlohmann/json.hpp>
+
+#include "cpph/refl/core.hxx"
+#include "cpph/refl/detail/if_archive.hxx"
+
+namespace perfkit::v2::_configs {
+using nlohmann::json;
+
+/**
+ * Writes reflected object directly into nlohmann::json DOM, without any intermediate
+ *  serialization.
+ */
+class json_dom_writer : public archive::if_writer
+{
+    json* _root = nullptr;
+    vector<json*> _stack;
+
+    bool _key_next = false;
+    string _key;
+    json::binary_t::container_type _binary;
+
+   public:
+    explicit json_dom_writer(json* root = nullptr) noexcept : if_writer(nullptr), _root(root) {}
+
+    //! Rebind output. Previous context will be discarded.
+    void reset(json* root) noexcept
+    {
+        _root = root;
+        _stack.clear();
+        _key_next = false;
+    }
+
+   public:
+    if_writer& write(nullptr_t) override { return *_next() = nullptr, *this; }
+    if_writer& write(bool v) override { return *_next() = v, *this; }
+    if_writer& write(int64_t v) override { return *_next() = v, *this; }
+    if_writer& write(double v) override { return *_next() = v, *this; }
+
+    if_writer& write(std::string_view v) override
+    {
+        if (_key_next) {
+            _key_next = false;
+            _key.assign(v.begin(), v.end());
+        } else {
+            *_next() = v;
+        }
+
+        return *this;
+    }
+
+    void object_push(size_t) override
+    {
+        auto node = _next();
+        *node = json::object();
+        _stack.push_back(node);
+    }
+
+    void array_push(size_t num_elems) override
+    {
+        auto node = _next();
+        *node = json::array();
+        node->get_ref<json::array_t&>().reserve(num_elems);
+        _stack.push_back(node);
+    }
+
+    void object_pop() override { _stack.pop_back(); }
+    void array_pop() override { _stack.pop_back(); }
+
+    void binary_push(size_t total) override
+    {
+        _binary.clear();
+        _binary.reserve(total);
+    }
+
+    void binary_write_some(const_buffer_view view) override
+    {
+        auto begin = reinterpret_cast<uint8_t const*>(view.data());
+        _binary.insert(_binary.end(), begin, begin + view.size());
+    }
+
+    void binary_pop() override
+    {
+        *_next() = json::binary(move(_binary));
+        _binary = {};
+    }
+
+    void write_key_next() override { _key_next = true; }
+    bool is_key_next() const override { return _key_next; }
+
+   private:
+    json* _next()
+    {
+        if (_stack.empty()) { return _root; }
+
+        auto top = _stack.back();
+        if (top->is_array()) { return &top->emplace_back(); }
+
+        return &(*top)[_key];
+    }
+};
+
+/**
+ * Reads reflected object directly from nlohmann::json DOM.
+ */
+class json_dom_reader : public archive::if_reader
+{
+    struct frame_t {
+        json const* node;
+        size_t index = 0;
+        json::const_iterator iter;
+    };
+
+    json const* _root = nullptr;
+    bool _root_consumed = false;
+    vector<frame_t> _stack;
+
+    bool _key_next = false;
+
+    json::binary_t const* _binary = nullptr;
+    size_t _binary_pos = 0;
+
+   public:
+    explicit json_dom_reader(json const* root = nullptr) noexcept : if_reader(nullptr), _root(root) {}
+
+    //! Rebind input. Previous context will be discarded.
+    void reset(json const* root) noexcept
+    {
+        _root = root;
+        _root_consumed = false;
+        _stack.clear();
+        _key_next = false;
+        _binary = nullptr;
+    }
+
+   public:
+    if_reader& read(nullptr_t) override
+    {
+        // Skips single entity
+        return _take(), *this;
+    }
+
+    if_reader& read(bool& v) override { return v = _take()->get<bool>(), *this; }
+    if_reader& read(int64_t& v) override { return v = _take()->get<int64_t>(), *this; }
+    if_reader& read(double& v) override { return v = _take()->get<double>(), *this; }
+
+    if_reader& read(string& v) override
+    {
+        if (_key_next) {
+            _key_next = false;
+            v = _stack.back().iter.key();
+        } else {
+            v = _take()->get_ref<json::string_t const&>();
+        }
+
+        return *this;
+    }
+
+    archive::context_key begin_object() override
+    {
+        auto node = _take();
+        if (not node->is_object()) { throw std::runtime_error{"json_dom_reader: object expected"}; }
+
+        _stack.push_back({node, 0, node->begin()});
+        return {1};
+    }
+
+    archive::context_key begin_array() override
+    {
+        auto node = _take();
+        if (not node->is_array()) { throw std::runtime_error{"json_dom_reader: array expected"}; }
+
+        _stack.push_back({node, 0, node->begin()});
+        return {1};
+    }
+
+    void end_object(archive::context_key) override { _stack.pop_back(), _key_next = false; }
+    void end_array(archive::context_key) override { _stack.pop_back(); }
+    void read_key_next() override { _key_next = true; }
+
+    size_t begin_binary() override
+    {
+        auto node = _take();
+        _binary = &node->get_binary();
+        _binary_pos = 0;
+
+        return _binary->size();
+    }
+
+    size_t binary_read_some(mutable_buffer_view v) override
+    {
+        auto n = std::min<size_t>(v.size(), _binary->size() - _binary_pos);
+        std::copy_n(_binary->data() + _binary_pos, n, reinterpret_cast<uint8_t*>(v.data()));
+        _binary_pos += n;
+
+        return n;
+    }
+
+    void end_binary() override { _binary = nullptr; }
+
+    bool should_break(archive::context_key const&) const override
+    {
+        return _peek() == nullptr;
+    }
+
+    archive::entity_type type_next() const override
+    {
+        using archive::entity_type;
+        if (_key_next) { return entity_type::string; }
+
+        auto node = _peek();
+        if (node == nullptr) { return entity_type::invalid; }
+
+        switch (node->type()) {
+            case json::value_t::null: return entity_type::null;
+            case json::value_t::object: return entity_type::object;
+            case json::value_t::array: return entity_type::array;
+            case json::value_t::string: return entity_type::string;
+            case json::value_t::boolean: return entity_type::boolean;
+            case json::value_t::number_integer:
+            case json::value_t::number_unsigned: return entity_type::integer;
+            case json::value_t::number_float: return entity_type::floating_point;
+            case json::value_t::binary: return entity_type::binary;
+            default: return entity_type::invalid;
+        }
+    }
+
+   private:
+    json const* _peek() const
+    {
+        if (_stack.empty()) { return _root_consumed ? nullptr : _root; }
+
+        auto& top = _stack.back();
+        if (top.node->is_array()) {
+            return top.index < top.node->size() ? &(*top.node)[top.index] : nullptr;
+        } else {
+            return top.iter != top.node->end() ? &top.iter.value() : nullptr;
+        }
+    }
+
+    json const* _take()
+    {
+        auto node = _peek();
+        if (node == nullptr) { throw std::runtime_error{"json_dom_reader: no more entity to read"}; }
+
+        if (_stack.empty()) {
+            _root_consumed = true;
+        } else if (auto& top = _stack.back(); top.node->is_array()) {
+            ++top.index;
+        } else {
+            ++top.iter;
+        }
+
+        return node;
+    }
+};
+}  // namespace perfkit::v2::_configs
@@ -0,0 +1,165 @@
+/*******************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2022. Seungwoo Kang
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * project home: https://github.com/perfkitpp
+ ******************************************************************************/
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "cpph/helper/macros.hxx"
+#include "perfkit/detail/base.hpp"
+#include "perfkit/detail/configs-v2.hpp"
+
+#if __linux__
+#    include <poll.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+static auto CPPH_LOGGER() { return perfkit::glog().get(); }
+
+namespace perfkit::v2 {
+#if __linux__
+namespace _configs {
+/**
+ * Watches parent directory of the config file, as editors usually replace the file by
+ *  renaming instead of overwriting it in place.
+ */
+class config_file_watcher
+{
+    string _path;
+    string _filename;
+    std::chrono::milliseconds _debounce;
+
+    int _inotify = -1;
+    int _wakeup[2] = {-1, -1};
+    std::thread _worker;
+
+   public:
+    config_file_watcher(string_view path, std::chrono::milliseconds debounce)
+            : _path(path), _debounce(debounce)
+    {
+        namespace fs = std::filesystem;
+        fs::path fpath{_path};
+        auto dir = fpath.parent_path();
+
+        _filename = fpath.filename().string();
+        if (dir.empty()) { dir = "."; }
+
+        _inotify = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        if (_inotify == -1) { return; }
+
+        constexpr auto mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+        if (inotify_add_watch(_inotify, dir.c_str(), mask) == -1) { return; }
+        if (pipe(_wakeup) == -1) { return; }
+
+        _worker = std::thread{&config_file_watcher::_loop, this};
+    }
+
+    ~config_file_watcher()
+    {
+        if (_worker.joinable()) {
+            char c = 0;
+            (void)!write(_wakeup[1], &c, 1);
+            _worker.join();
+        }
+
+        for (auto fd : {_inotify, _wakeup[0], _wakeup[1]})
+            if (fd != -1) { close(fd); }
+    }
+
+    bool valid() const noexcept { return _worker.joinable(); }
+
+   private:
+    void _loop()
+    {
+        using clock = std::chrono::steady_clock;
+
+        alignas(inotify_event) char buf[4096];
+        optional<clock::time_point> reload_at;
+
+        for (;;) {
+            int timeout = -1;
+            if (reload_at) {
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(*reload_at - clock::now());
+                timeout = std::max<int>(0, left.count());
+            }
+
+            pollfd fds[2] = {{_inotify, POLLIN, 0}, {_wakeup[0], POLLIN, 0}};
+            auto n_ready = poll(fds, 2, timeout);
+
+            if (n_ready == -1 && errno != EINTR) {
+                CPPH_ERROR("Config file watcher for '{}' stopped: poll() failed", _path);
+                break;
+            }
+
+            if (fds[1].revents) { break; }
+
+            if (fds[0].revents & POLLIN) {
+                ssize_t n_read;
+                while ((n_read = read(_inotify, buf, sizeof buf)) > 0) {
+                    for (char* p = buf; p < buf + n_read;) {
+                        auto ev = reinterpret_cast<inotify_event const*>(p);
+                        p += sizeof(inotify_event) + ev->len;
+
+                        if (ev->len && _filename == ev->name) {
+                            // Restart debounce timer on every event
+                            reload_at = clock::now() + _debounce;
+                        }
+                    }
+                }
+            }
+
+            if (reload_at && clock::now() >= *reload_at) {
+                reload_at.reset();
+                configs_reload(_path);
+            }
+        }
+    }
+};
+}  // namespace _configs
+
+auto configs_watch(string_view path, std::chrono::milliseconds debounce) -> shared_ptr<void>
+{
+    auto watcher = make_shared<_configs::config_file_watcher>(path, debounce);
+    if (not watcher->valid()) {
+        CPPH_ERROR("Failed to watch config file '{}': {}", path, strerror(errno));
+        return nullptr;
+    }
+
+    CPPH_INFO("Watching config file '{}' ...", path);
+    return watcher;
+}
+#else
+auto configs_watch(string_view path, std::chrono::milliseconds) -> shared_ptr<void>
+{
+    CPPH_WARN("Config file watching is not supported on this platform. ('{}')", path);
+    return nullptr;
+}
+#endif
+}  // namespace perfkit::v2
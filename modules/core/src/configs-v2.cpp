@@ -26,8 +26,16 @@
 
 #include "perfkit/detail/configs-v2.hpp"
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <list>
 #include <regex>
 #include <set>
+#include <thread>
 
 #include <fmt/core.h>
 #include <nlohmann/json.hpp>
@@ -40,6 +48,11 @@
 #include "perfkit/configs-v2.h"
 #include "perfkit/detail/base.hpp"
 #include "perfkit/detail/configs-v2-backend.hpp"
+#include "configs-v2-json.hpp"
+
+#if !defined(_WIN32)
+extern char** environ;
+#endif
 
 static auto CPPH_LOGGER() { return perfkit::glog().get(); }
 
@@ -58,12 +71,176 @@ config_base::~config_base() noexcept
 }
 
 namespace _configs {
+/**
+ * Single background thread which applies queued changes of opted-in registries.
+ */
+class propagation_worker
+{
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    bool _stop = false;
+
+    vector<config_registry_wptr> _pending;
+    std::thread _worker;
+
+   public:
+    static propagation_worker& get()
+    {
+        static propagation_worker inst;
+        return inst;
+    }
+
+    propagation_worker()
+    {
+        _worker = std::thread{&propagation_worker::_loop, this};
+    }
+
+    ~propagation_worker()
+    {
+        {
+            std::lock_guard _{_mtx};
+            _stop = true;
+        }
+
+        _cv.notify_all();
+        _worker.join();
+    }
+
+    void post(config_registry_wptr rg)
+    {
+        {
+            std::lock_guard _{_mtx};
+            _pending.emplace_back(move(rg));
+        }
+
+        _cv.notify_one();
+    }
+
+   private:
+    void _loop()
+    {
+        vector<config_registry_wptr> queue;
+        std::unique_lock lc{_mtx};
+
+        for (;;) {
+            _cv.wait(lc, [&] { return _stop || not _pending.empty(); });
+            if (_stop) { break; }
+
+            swap(queue, _pending);
+            lc.unlock();
+
+            for (auto& wp : queue)
+                if (auto rg = wp.lock())
+                    rg->backend()->_internal_propagate();
+
+            queue.clear();
+            lc.lock();
+        }
+    }
+};
+
+/**
+ * Runs asynchronous config validations. Validators may block, thus multiple threads
+ *  serve the queue.
+ */
+class validation_worker
+{
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    bool _stop = false;
+
+    std::list<ufunction<void()>> _pending;
+    vector<std::thread> _workers;
+
+   public:
+    static validation_worker& get()
+    {
+        static validation_worker inst;
+        return inst;
+    }
+
+    validation_worker()
+    {
+        auto num_workers = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+
+        for (auto i = 0u; i < num_workers; ++i)
+            _workers.emplace_back(&validation_worker::_loop, this);
+    }
+
+    ~validation_worker()
+    {
+        {
+            std::lock_guard _{_mtx};
+            _stop = true;
+        }
+
+        _cv.notify_all();
+        for (auto& th : _workers) { th.join(); }
+    }
+
+    void post(ufunction<void()> fn)
+    {
+        {
+            std::lock_guard _{_mtx};
+            _pending.emplace_back(move(fn));
+        }
+
+        _cv.notify_one();
+    }
+
+   private:
+    void _loop()
+    {
+        std::unique_lock lc{_mtx};
+
+        for (;;) {
+            _cv.wait(lc, [&] { return _stop || not _pending.empty(); });
+            if (_stop) { break; }
+
+            auto fn = move(_pending.front());
+            _pending.pop_front();
+            lc.unlock();
+
+            fn();
+
+            lc.lock();
+        }
+    }
+};
+
+/**
+ * Snapshot of process environment, which is taken on first use. Each binding is then
+ *  resolved by single hash lookup, instead of getenv() call.
+ */
+static auto environment_snapshot() -> std::unordered_map<string, string> const&
+{
+    static auto const snapshot = [] {
+#if defined(_WIN32)
+        char** env = _environ;
+#else
+        char** env = environ;
+#endif
+        std::unordered_map<string, string> table;
+
+        for (; env && *env; ++env) {
+            string_view entry = *env;
+            auto pos = entry.find('=');
+            if (pos == string_view::npos || pos == 0) { continue; }
+
+            table.try_emplace(string{entry.substr(0, pos)}, entry.substr(pos + 1));
+        }
+
+        return table;
+    }();
+
+    return snapshot;
+}
 
 void verify_flag_string(string_view str)
 {
     assert(not str.empty() && "Empty string not allowed!");
     assert(isalnum(str[0]) && "First character must be alphanumeric!");
-    assert(str != "h" && str != "help" && "'HELP' flag is reserved!");
+    // 'h' and 'help' can be bound. Then configs_parse_args() doesn't treat them as help.
     assert(str.find("no-") != 0 && "'no-' prefixed flag is reserved!");
     assert(str.find("--") == string::npos && "Consecutive '--' is not allowed!");
     assert(all_of(str, [](auto c) { return isalnum(c) || c == '-' || c == '_'; }));
@@ -72,7 +249,8 @@ void verify_flag_string(string_view str)
 
 config_registry::config_registry(ctor_constraint_t, std::string name, bool is_global)
         : _self(make_unique<backend_t>(this, move(name), is_global)),
-          on_update_notify(&_self->evt_update_listener)
+          on_update_notify(&_self->evt_update_listener),
+          on_fence_update(&_self->evt_fence_updated)
 {
 }
 
@@ -93,12 +271,11 @@ void config_registry::_internal_item_add(config_base_ptr arg, string prefix)
 
         assert(not arg->_rg);
         arg->_rg = shared_from_this();
-
-        auto prefix_len = prefix.size();
-        arg->_cached_full_key = move(prefix) + arg->name();
-        arg->_cached_prefix = string_view{arg->_cached_full_key}.substr(0, prefix_len);
     }
 
+    prefix += arg->name();
+    arg->_key.store(_configs::intern_key(prefix), std::memory_order_release);
+
     _self->_events.post(
             [this,
              arg = move(arg),
@@ -131,6 +308,29 @@ void config_registry::_internal_item_remove(config_base_wptr arg)
 void config_registry::item_notify()
 {
     _self->_events.post([this] { _self->_flag_add_remove_notified = true; });
+    _self->_internal_request_propagation();
+}
+
+void config_registry::use_propagation_worker(bool enabled)
+{
+    release(_self->_use_propagation_worker, enabled);
+
+    // There might be changes queued before.
+    if (enabled) { _self->_internal_request_propagation(); }
+}
+
+void config_registry::backend_t::_internal_request_propagation()
+{
+    if (not acquire(_use_propagation_worker) || not acquire(_is_registered)) { return; }
+    if (_propagation_pending.exchange(true)) { return; }  // Already queued
+
+    _configs::propagation_worker::get().post(_owner->weak_from_this());
+}
+
+void config_registry::backend_t::_internal_propagate()
+{
+    release(_propagation_pending, false);
+    _do_update();
 }
 
 bool config_registry::update()
@@ -164,6 +364,43 @@ static bool attribute_validate(config_attribute const& attr, refl::object_view_t
         && (not attr.fn_validate || attr.fn_validate(view));
 }
 
+bool config_registry::_internal_commit_batch(
+        array_view<pair<config_base_ptr, refl::shared_object_ptr>> items, string_view source)
+{
+    return _self->_commit_batch(items, source);
+}
+
+config_transaction config_registry::transaction(string_view source)
+{
+    return config_transaction{shared_from_this(), source};
+}
+
+config_transaction& config_transaction::stage(config_id_t id, archive::if_reader* content)
+{
+    auto conf = _rg->backend()->bk_find(id);
+    if (not conf) { return _failed = true, *this; }
+
+    auto object = conf->attribute()->fn_construct();
+
+    try {
+        *content >> object.view();
+    } catch (std::exception& e) {
+        return _failed = true, *this;
+    }
+
+    return stage(move(conf), move(object));
+}
+
+bool config_transaction::commit()
+{
+    bool succeeded = not _failed && _rg->_internal_commit_batch(_items, _source);
+
+    _items.clear();
+    _failed = false;
+
+    return succeeded;
+}
+
 bool config_registry::_internal_commit_inplace_user(config_base* ref, refl::object_view_t view)
 {
     return backend()->_internal_commit_inplace(ref, view);
@@ -177,17 +414,16 @@ bool config_registry::is_registered() const
 bool config_registry::backend_t::_internal_commit_inplace(config_base* ref, refl::object_view_t view)
 {
     if (attribute_validate(*ref->attribute(), view)) {
-        {
-            CPPH_TMPVAR{lock_guard{ref->_mtx_raw_access}};
-            ref->attribute()->fn_swap_value(ref->_body.raw_data.view(), view);
-        }
+        ref->_modify_raw([&] { ref->attribute()->fn_swap_value(ref->_body.raw_data.view(), view); });
 
         CPPH_TMPVAR{lock_guard{_mtx_access}};
-        auto ctx = find_ptr(_configs, ref->id());
+        auto ctx = _find_slot(ref->id());
         if (not ctx) { return false; }  // Possibly removed during validation
 
-        set_push(_inplace_updates, ref->id());
+        ++ctx->commit_seq;
+        _dirty_inplace.set(ctx - _slots.data());
         release(_has_update, true);
+        _internal_request_propagation();
 
         return true;
     }
@@ -195,16 +431,45 @@ bool config_registry::backend_t::_internal_commit_inplace(config_base* ref, refl
     return false;
 }
 
-bool config_registry::backend_t::_commit(config_base* ref, refl::shared_object_ptr candidate)
+bool config_registry::backend_t::_commit(
+        config_base* ref, refl::shared_object_ptr candidate, weak_ptr<void> origin, string_view source)
 {
+    if (ref->attribute()->async_validate) {
+        uint64_t seq;
+
+        {
+            CPPH_TMPVAR{lock_guard{_mtx_access}};
+            auto ctx = _find_slot(ref->id());
+            if (not ctx) { return false; }
+
+            seq = ++ctx->commit_seq;
+        }
+
+        _configs::validation_worker::get().post(
+                [wrg = _owner->weak_from_this(), wref = ref->weak_from_this(),
+                 candidate = move(candidate), origin = move(origin), source, seq]() mutable {
+                    auto rg = wrg.lock();
+                    auto ref = wref.lock();
+                    if (not rg || not ref) { return; }
+
+                    bool valid = attribute_validate(*ref->attribute(), candidate.view());
+                    rg->backend()->_commit_validated(ref.get(), move(candidate), move(origin), source, seq, valid);
+                });
+
+        return true;
+    }
+
     if (attribute_validate(*ref->attribute(), candidate.view())) {
         CPPH_TMPVAR{lock_guard{_mtx_access}};
-        auto ctx = find_ptr(_configs, ref->id());
+        auto ctx = _find_slot(ref->id());
         if (not ctx) { return false; }  // Possibly removed during validation
 
-        swap(ctx->second._staged, candidate);
-        set_push(_refreshed_items, ref->id());
+        ++ctx->commit_seq;
+        swap(ctx->_staged, candidate);
+        ctx->staged_source = source;
+        _dirty_staged.set(ctx - _slots.data());
         release(_has_update, true);
+        _internal_request_propagation();
 
         return true;
     } else {
@@ -212,7 +477,34 @@ bool config_registry::backend_t::_commit(config_base* ref, refl::shared_object_p
     }
 }
 
-bool config_registry::backend_t::bk_commit(config_base* ref, archive::if_reader* content)
+void config_registry::backend_t::_commit_validated(
+        config_base* ref, refl::shared_object_ptr candidate, weak_ptr<void> origin,
+        string_view source, uint64_t seq, bool valid)
+{
+    {
+        CPPH_TMPVAR{lock_guard{_mtx_access}};
+        auto ctx = _find_slot(ref->id());
+        if (not ctx) { return; }
+
+        // Newer commit was made during validation; this one is outdated.
+        if (ctx->commit_seq != seq) { return; }
+
+        if (valid) {
+            swap(ctx->_staged, candidate);
+            ctx->staged_source = source;
+            _dirty_staged.set(ctx - _slots.data());
+        } else {
+            _rejections.push_back({ref->id(), move(origin)});
+        }
+
+        release(_has_update, true);
+    }
+
+    _internal_request_propagation();
+}
+
+bool config_registry::backend_t::bk_commit(
+        config_base* ref, archive::if_reader* content, weak_ptr<void> origin, string_view source)
 {
     auto object = ref->_body.attribute->fn_construct();
 
@@ -222,40 +514,308 @@ bool config_registry::backend_t::bk_commit(config_base* ref, archive::if_reader*
         return false;
     }
 
-    return _commit(ref, move(object));
+    return _commit(ref, move(object), move(origin), source);
+}
+
+bool config_registry::backend_t::_commit_batch(
+        array_view<pair<config_base_ptr, refl::shared_object_ptr>> items, string_view source)
+{
+    // Validate all before staging anything
+    for (auto& [ref, candidate] : items)
+        if (not attribute_validate(*ref->attribute(), candidate.view()))
+            return false;
+
+    {
+        CPPH_TMPVAR{lock_guard{_mtx_access}};
+
+        // Check existence of all items first, as any of them might be removed during validation.
+        for (auto& [ref, candidate] : items)
+            if (not _find_slot(ref->id()))
+                return false;
+
+        for (auto& [ref, candidate] : items) {
+            auto ctx = _find_slot(ref->id());
+            ++ctx->commit_seq;
+            swap(ctx->_staged, candidate);
+            ctx->staged_source = source;
+            _dirty_staged.set(ctx - _slots.data());
+        }
+
+        release(_has_update, true);
+    }
+
+    _internal_request_propagation();
+    return true;
+}
+
+void config_registry::backend_t::_record_history(size_t fence) noexcept
+{
+    {
+        CPPH_TMPVAR{lock_guard{_mtx_history}};
+        if (_history_capacity == 0) {
+            // Recording disabled; don't waste time on encoding.
+            _history_pending.clear();
+            return;
+        }
+    }
+
+    auto timestamp = std::chrono::system_clock::now();
+
+    for (auto& pending : _history_pending) {
+        auto conf = _update_buffer[pending.update_index].get();
+        auto& old_value = _retired_staged[pending.retired_index];
+        size_t new_value_offset = 0;
+
+        // Encode outside of history lock. Failure drops only this record, as the value
+        //  itself is already applied.
+        try {
+            _history_scratch.clear();
+            streambuf::stringbuf sbuf{&_history_scratch};
+            archive::msgpack::writer writer{&sbuf};
+
+            writer << old_value.view();
+            writer.flush();
+            new_value_offset = _history_scratch.size();
+
+            // Read lock of the config must be released before exception propagates.
+            std::exception_ptr error;
+            bk_access_value_shared(conf, [&](auto&& raw) {
+                try {
+                    writer << raw.view();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            });
+
+            if (error) { std::rethrow_exception(error); }
+            writer.flush();
+        } catch (std::exception& e) {
+            CPPH_ERROR("Config Repo '{}': Failed to record history of '{}': {}", _name, conf->full_key(), e.what());
+            continue;
+        }
+
+        CPPH_TMPVAR{lock_guard{_mtx_history}};
+        if (_history_capacity == 0) { break; }
+
+        config_history_entry* entry;
+        if (_history.size() < _history_capacity) {
+            try {
+                entry = &_history.emplace_back();
+            } catch (std::bad_alloc&) {
+                break;
+            }
+        } else {
+            // Overwrite the oldest one
+            entry = &_history[_history_begin];
+            _history_lost_fence = entry->fence;
+            _history_begin = (_history_begin + 1) % _history.size();
+        }
+
+        entry->fence = fence;
+        entry->timestamp = timestamp;
+        entry->id = pending.id;
+        entry->key = conf->full_key();
+        entry->source = pending.source;
+        entry->new_value_offset = new_value_offset;
+
+        // Payload buffer of overwritten entry is reused on next encoding.
+        swap(entry->payload, _history_scratch);
+    }
+
+    _history_pending.clear();
+}
+
+void config_registry::backend_t::bk_history_capacity(size_t capacity)
+{
+    CPPH_TMPVAR{lock_guard{_mtx_history}};
+
+    // Linearize ring, keeping newest entries only.
+    std::rotate(_history.begin(), _history.begin() + _history_begin, _history.end());
+    _history_begin = 0;
+
+    if (_history.size() > capacity) {
+        auto n_drop = _history.size() - capacity;
+        _history_lost_fence = _history[n_drop - 1].fence;
+        _history.erase(_history.begin(), _history.begin() + n_drop);
+    }
+
+    _history_capacity = capacity;
+}
+
+void config_registry::backend_t::bk_history(vector<config_history_entry>* out) const
+{
+    CPPH_TMPVAR{lock_guard{_mtx_history}};
+    out->reserve(out->size() + _history.size());
+
+    for (size_t i = 0; i < _history.size(); ++i)
+        out->push_back(_history[(_history_begin + i) % _history.size()]);
 }
 
-bool config_registry::backend_t::bk_commit(config_id_t id, archive::if_reader* content)
+bool config_registry::backend_t::bk_rollback(size_t fence)
 {
-    config_base_ptr config;
+    // Value at given fence is the old value of the first change made after it.
+    std::unordered_map<config_id_t, string> restore;
+
     {
-        CPPH_TMPVAR{std::shared_lock{_mtx_access}};
-        if (auto p_pair = find_ptr(_configs, id)) {
-            config = p_pair->second.reference.lock();
+        CPPH_TMPVAR{lock_guard{_mtx_history}};
+        if (fence < _history_lost_fence) { return false; }
+
+        for (size_t i = 0; i < _history.size(); ++i)
+            if (auto& entry = _history[(_history_begin + i) % _history.size()]; entry.fence > fence)
+                restore.try_emplace(entry.id, entry.old_value());
+    }
+
+    vector<pair<config_base_ptr, refl::shared_object_ptr>> items;
+    items.reserve(restore.size());
+
+    for (auto& [id, value] : restore) {
+        auto conf = bk_find(id);
+        if (not conf) { continue; }  // Already disposed
+
+        auto object = conf->attribute()->fn_construct();
+
+        try {
+            streambuf::view sbuf{{value.data(), value.size()}};
+            archive::msgpack::reader reader{&sbuf};
+            reader >> object.view();
+        } catch (std::exception& e) {
+            CPPH_ERROR("Config Repo '{}': Failed to restore '{}': {}", _name, conf->full_key(), e.what());
+            return false;
+        }
+
+        items.emplace_back(move(conf), move(object));
+    }
+
+    if (items.empty()) { return true; }
+    return _commit_batch(items, "rollback");
+}
+
+config_base_ptr config_registry::backend_t::bk_find(config_id_t id) const noexcept
+{
+    CPPH_TMPVAR{std::shared_lock{_mtx_access}};
+    if (auto ctx = _find_slot(id))
+        return ctx->reference.lock();
+
+    return nullptr;
+}
+
+config_entity_context* config_registry::backend_t::_find_slot(config_id_t id) noexcept
+{
+    auto p_slot = find_ptr(_slot_table, id);
+    return p_slot ? &_slots[p_slot->second] : nullptr;
+}
+
+config_entity_context const* config_registry::backend_t::_find_slot(config_id_t id) const noexcept
+{
+    auto p_slot = find_ptr(_slot_table, id);
+    return p_slot ? &_slots[p_slot->second] : nullptr;
+}
+
+config_entity_context* config_registry::backend_t::_acquire_slot(config_id_t id)
+{
+    uint32_t slot;
+
+    if (not _vacant_slots.empty()) {
+        slot = _vacant_slots.back();
+        _vacant_slots.pop_back();
+    } else {
+        slot = uint32_t(_slots.size());
+        _slots.emplace_back();
+        _dirty_staged.reserve_slots(_slots.size());
+        _dirty_inplace.reserve_slots(_slots.size());
+    }
+
+    _slot_table.try_emplace(id, slot);
+
+    auto ctx = &_slots[slot];
+    ctx->id = id;
+    return ctx;
+}
+
+void config_registry::backend_t::_release_slot(config_entity_context* ctx)
+{
+    auto slot = uint32_t(ctx - _slots.data());
+
+    _disown_key(ctx);
+    _slot_table.erase(ctx->id);
+    _dirty_staged.reset(slot);
+    _dirty_inplace.reset(slot);
+
+    *ctx = {};
+    _vacant_slots.push_back(slot);
+}
+
+void config_registry::backend_t::_own_key(config_entity_context* ctx, _configs::interned_key const* key)
+{
+    if (ctx->interned_key == key) { return; }
+
+    _disown_key(ctx);
+    ctx->interned_key = key;
+    ctx->full_key_cached = key ? key->str : string_view{};
+    if (not key) { return; }
+
+    auto [iter, is_new] = _key_owners.try_emplace(key);
+    if (is_new)
+        iter->second.owner = ctx->id;
+    else
+        iter->second.successors.push_back(ctx->id);
+}
+
+void config_registry::backend_t::_disown_key(config_entity_context* ctx)
+{
+    auto iter = _key_owners.find(ctx->interned_key);
+    if (iter == _key_owners.end()) { return; }
+
+    // Key is handed over to another config with same key, if there's any.
+    auto& owners = iter->second;
+    if (owners.owner == ctx->id) {
+        if (owners.successors.empty()) {
+            _key_owners.erase(iter);
+            return;
         }
+
+        owners.owner = owners.successors.front();
+        owners.successors.erase(owners.successors.begin());
+    } else {
+        auto& s = owners.successors;
+        s.erase(std::remove(s.begin(), s.end(), ctx->id), s.end());
     }
+}
+
+bool config_registry::backend_t::bk_commit(
+        config_id_t id, archive::if_reader* content, weak_ptr<void> origin, string_view source)
+{
+    auto config = bk_find(id);
 
     if (config) {
-        return bk_commit(config.get(), content);
+        return bk_commit(config.get(), content, move(origin), source);
     } else {
         return false;
     }
 }
 
+// Registry of which update() is running on current thread, to detect reentrance from callbacks.
+static thread_local void const* g_updating_registry = nullptr;
+
+std::unique_lock<std::mutex> config_registry::_internal_lock_update()
+{
+    if (g_updating_registry == _self.get()) { return {}; }
+    return std::unique_lock{_self->_mtx_update};
+}
+
 void config_registry::backend_t::_do_update()
 {
+    CPPH_TMPVAR{lock_guard{_mtx_update}};
+
+    struct updating_scope_t {
+        void const* prev;
+        ~updating_scope_t() { g_updating_registry = prev; }
+    } updating_scope{exchange(g_updating_registry, this)};
+
     // Event entities ...
     bool has_structure_change = false;
     bool has_committed_update = false;
-    list<config_base_ptr> updates;
-
-    auto pool = &_free_evt_nodes;
-    auto checkout_push =
-            [pool](list<config_base_ptr>* to, decltype(updates)::value_type ptr) {
-                auto iter = pool->empty() ? pool->emplace(pool->end()) : pool->begin();
-                *iter = forward<decltype(ptr)>(ptr);
-                to->splice(to->end(), *pool, iter);
-            };
+    auto& updates = _update_buffer;
 
     if (not _events.empty()) {
         CPPH_TMPVAR{lock_guard{_mtx_access}};
@@ -279,69 +839,70 @@ void config_registry::backend_t::_do_update()
     if (bool has_update; try_exchange(_has_update, false, &has_update) && has_update) {
         CPPH_TMPVAR{lock_guard{_mtx_access}};
 
-        // Check for updates
-        if (not _refreshed_items.empty()) {
-            for (auto id : _refreshed_items) {
-                // Check if config is erased
-                auto iter = _configs.find(id);
-                if (iter == _configs.end()) { continue; }
-
-                // Check if config is expired
-                auto* node = &iter->second;
-                auto conf = node->reference.lock();
-                if (not conf) {
-                    // Configuration is expired ... collect garbage.
-                    release(_has_expired_ref, true);
-                    continue;
-                }
+        // Collect rejections of asynchronous validation
+        swap(_rejection_buffer, _rejections);
 
-                // Perform actual update
-                assert(node->_staged && "Staged data must be prepared!");
+        // Check for updates. Released slots are never marked, as their bits are cleared.
+        _dirty_staged.consume([&](size_t slot) {
+            auto* node = &_slots[slot];
 
-                {
-                    CPPH_TMPVAR{lock_guard{conf->_mtx_raw_access}};
-                    conf->attribute()->fn_swap_value(conf->_body.raw_data.view(), node->_staged.view());
-                }
+            // Check if config is expired
+            auto conf = node->reference.lock();
+            if (not conf) {
+                // Configuration is expired ... collect garbage.
+                release(_has_expired_ref, true);
+                return;
+            }
 
-                node->_staged.reset();  // Clear staged data
+            // Perform actual update
+            assert(node->_staged && "Staged data must be prepared!");
 
-                // Increase modification fence
-                conf->_fence_modified.fetch_add(1);
+            conf->_modify_raw([&] {
+                conf->attribute()->fn_swap_value(conf->_body.raw_data.view(), node->_staged.view());
+            });
 
-                // Append to 'updated' list.
-                checkout_push(&updates, move(conf));
-                has_committed_update = true;
+            // Old value is swapped into staged object. Keep it until history is recorded.
+            _history_pending.push_back({updates.size(), _retired_staged.size(), node->id, node->staged_source});
+            _retired_staged.emplace_back(move(node->_staged));  // Clear staged data
+
+            // Increase modification fence
+            conf->_fence_modified.fetch_add(1);
+
+            // Append to 'updated' list.
+            updates.emplace_back(move(conf));
+            has_committed_update = true;
+        });
+
+        _dirty_inplace.consume([&](size_t slot) {
+            // Check if config is expired
+            auto conf = _slots[slot].reference.lock();
+            if (not conf) {
+                // Configuration is expired ... collect garbage.
+                release(_has_expired_ref, true);
+                return;
             }
 
-            _refreshed_items.clear();
-        }
+            // Append to 'updated' list.
+            updates.emplace_back(move(conf));
+        });
+    }
 
-        if (not _inplace_updates.empty()) {
-            for (auto id : _inplace_updates) {
-                // Check if config is erased
-                auto iter = _configs.find(id);
-                if (iter == _configs.end()) { continue; }
+    // Record history and return swapped-out values to staging pool, outside of protected
+    //  scope. As _mtx_update is still held, no other update can modify values meanwhile.
+    //  Fence is increased once at the end of this update, thus changes are recorded with it.
+    if (not _history_pending.empty()) { _record_history(acquire(_fence) + 1); }
+    _retired_staged.clear();
 
-                // Check if config is expired
-                auto* node = &iter->second;
-                auto conf = node->reference.lock();
-                if (not conf) {
-                    // Configuration is expired ... collect garbage.
-                    release(_has_expired_ref, true);
-                    continue;
-                }
+    if (bool has_disposal; try_exchange(_has_expired_ref, false, &has_disposal)) {
+        CPPH_TMPVAR{lock_guard{_mtx_access}};
+        size_t n_expired = 0;
 
-                // Append to 'updated' list.
-                checkout_push(&updates, move(conf));
+        for (auto& ctx : _slots) {
+            if (ctx.id.value != 0 && ctx.reference.expired()) {
+                _release_slot(&ctx);
+                ++n_expired;
             }
-
-            _inplace_updates.clear();
         }
-    }
-
-    if (bool has_disposal; try_exchange(_has_expired_ref, false, &has_disposal)) {
-        auto n_expired = erase_if_each(
-                _configs, [](auto&& pair) { return pair.second.reference.expired(); });
 
         has_structure_change |= (n_expired != 0);
         CPPH_DEBUG("Config Repo '{}': {} configs disposed", _name, n_expired);
@@ -355,26 +916,62 @@ void config_registry::backend_t::_do_update()
     // Publish updates to subscribers
     if (has_structure_change) { evt_structure_changed.invoke(_owner); }
     if (not updates.empty()) { evt_updated_entities.invoke(_owner, updates); }
+    if (not _rejection_buffer.empty()) { evt_commit_rejected.invoke(_owner, _rejection_buffer); }
+    for (auto& conf : updates) { conf->on_update.invoke(conf.get()); }
+    if (has_structure_change || not updates.empty()) { evt_fence_updated.invoke(_owner); }
+
+    // Buffer must not keep references to configs
+    updates.clear();
+    _rejection_buffer.clear();
 }
 
-static auto _global_repo() noexcept
-{
-    static std::mutex _lock;
-    static std::map<config_registry_id_t, weak_ptr<config_registry>> _repo;
+namespace _configs {
+/**
+ * Global stores are sharded by registry name, thus registries being created in parallel
+ *  rarely contend on same lock.
+ */
+constexpr size_t num_global_shards = 16;
 
-    return make_pair(std::unique_lock{_lock}, &_repo);
+static size_t global_shard_index(string_view registry_name) noexcept
+{
+    return std::hash<string_view>{}(registry_name) % num_global_shards;
 }
 
-void config_registry::backend_t::bk_all_items(vector<config_base_ptr>* out) const noexcept
-{
-    // Retrieve all alive elements
+template <typename Storage>
+struct global_shard {
+    std::mutex lock;
+    Storage storage;
+};
+
+/**
+ * Registries are keyed by id, as multiple live registries may share same name. They still
+ *  land on the shard of their name.
+ */
+using global_repo_t = std::map<config_registry_id_t, weak_ptr<config_registry>>;
+}  // namespace _configs
+
+static auto& _global_repo_shards() noexcept
+{
+    static std::array<_configs::global_shard<_configs::global_repo_t>, _configs::num_global_shards> _shards;
+    return _shards;
+}
+
+static auto _global_repo(string_view registry_name) noexcept
+{
+    auto& shard = _global_repo_shards()[_configs::global_shard_index(registry_name)];
+    return make_pair(std::unique_lock{shard.lock}, &shard);
+}
+
+void config_registry::backend_t::bk_all_items(vector<config_base_ptr>* out) const noexcept
+{
+    // Retrieve all alive elements
     CPPH_TMPVAR{std::shared_lock{_mtx_access}};
-    out->reserve(out->size() + _configs.size());
+    out->reserve(out->size() + _slot_table.size());
 
     // Retrieve them as sorted
-    auto all_ = (config_entity_context const**)alloca(_configs.size() * sizeof(void*));
-    array_view<config_entity_context const*> all{all_, _configs.size()};
-    transform(_configs, all.begin(), [](auto& p) { return &p.second; });
+    vector<config_entity_context const*> all;
+    all.reserve(_slot_table.size());
+    _for_each_slot([&](auto& ctx) { all.push_back(&ctx); });
 
     sort(all, [](auto a, auto b) { return a->sort_order < b->sort_order; });
 
@@ -386,12 +983,14 @@ void config_registry::backend_t::bk_all_items(vector<config_base_ptr>* out) cons
 void config_registry::backend_t::bk_enumerate_registries(vector<config_registry_ptr>* out, bool include_unregistered) noexcept
 {
     // Retrieve all alive elements
-    auto [lock, repos] = _global_repo();
-    out->reserve(out->size() + repos->size());
+    for (auto& shard : _global_repo_shards()) {
+        CPPH_TMPVAR{lock_guard{shard.lock}};
+        out->reserve(out->size() + shard.storage.size());
 
-    for (auto& [_, wrepo] : *repos)
-        if (auto repo = wrepo.lock(); repo && (include_unregistered || repo->is_registered()))
-            out->emplace_back(move(repo));
+        for (auto& [_, wrepo] : shard.storage)
+            if (auto repo = wrepo.lock(); repo && (include_unregistered || repo->is_registered()))
+                out->emplace_back(move(repo));
+    }
 }
 
 bool config_registry::unregister()
@@ -409,9 +1008,10 @@ bool config_registry::unregister()
     CPPH_DEBUG("Unregistering '{}' from global registry ...", name());
     assert(not _self->_is_transient);
     {
-        auto [lock, repo] = _global_repo();
-        auto erase_result = repo->erase(id());
+        auto [lock, shard] = _global_repo(name());
+        auto erase_result = shard->storage.erase(id());
         assert(erase_result == 1 && "Once registered, registry must be unregistered exactly once.");
+        (void)erase_result;
     }
 
     // Propagate un-registration
@@ -444,12 +1044,153 @@ bool config_registry::is_transient() const
 #include "cpph/refl/types/tuple.hxx"
 
 namespace perfkit::v2 {
-static auto _g_config() noexcept
+static auto& _g_config_shards() noexcept
+{
+    static std::array<_configs::global_shard<global_config_storage_t>, _configs::num_global_shards> _shards;
+    return _shards;
+}
+
+//! Returns shard of global storage which contains given registry.
+static auto _g_config(string_view registry_name) noexcept
+{
+    auto& shard = _g_config_shards()[_configs::global_shard_index(registry_name)];
+    return pair{std::unique_lock{shard.lock}, &shard.storage};
+}
+
+//! Visit every shard of global storage, one by one.
+template <typename Fn>
+static void _g_config_for_each(Fn&& fn)
+{
+    for (auto& shard : _g_config_shards()) {
+        CPPH_TMPVAR{lock_guard{shard.lock}};
+        fn(&shard.storage);
+    }
+}
+
+//! Replace content of global storage.
+static void _g_config_assign(global_config_storage_t all)
+{
+    _g_config_for_each([](global_config_storage_t* p) { p->clear(); });
+
+    while (not all.empty()) {
+        auto node = all.extract(all.begin());
+        auto [_, p_shard] = _g_config(node.key());
+        p_shard->insert(move(node));
+    }
+}
+
+namespace _configs {
+/**
+ * Binary config snapshot layout. Every offset is relative to beginning of the file, and
+ *  integers are stored in host byte order, which is verified on load via endian mark.
+ *
+ * [header][entry table, sorted by (registry, key)][blob: names and msgpack values]
+ */
+struct binary_config_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_mark;
+    uint64_t num_entries;
+    uint64_t entry_offset;
+};
+
+struct binary_config_entry {
+    uint64_t registry_offset;
+    uint64_t key_offset;
+    uint64_t value_offset;
+    uint32_t registry_length;
+    uint32_t key_length;
+    uint64_t value_length;
+};
+
+constexpr char binary_config_magic[8] = {'P', 'K', 'C', 'F', 'G', 'B', 'I', 'N'};
+constexpr uint32_t binary_config_version = 1;
+constexpr uint32_t binary_config_endian_mark = 0x01020304;
+
+/**
+ * Imported config file, which is indexed by registry name and key, but not parsed yet.
+ * Each value is parsed only when it is actually required.
+ */
+struct lazy_config_source {
+    string content;
+    void* mapped_addr = nullptr;
+    size_t mapped_size = 0;
+    string_view text;
+
+    // For json source. Keys refer to text, or owned_keys if they're escaped.
+    map<string_view, map<string_view, string_view>> index;
+    std::list<string> owned_keys;
+
+    // For binary source. Entries refer to mapped file directly.
+    array_view<binary_config_entry const> entries;
+    vector<bool> entry_taken;
+
+   public:
+    ~lazy_config_source() noexcept;
+
+    bool is_binary() const noexcept { return not entries.empty(); }
+
+    //! Parse value and remove it from the source.
+    bool take(string_view registry, string_view key, nlohmann::json* out);
+
+    //! Parse all values of registry and remove them from the source.
+    void take_registry(string_view registry, config_registry_storage_t* out);
+
+    //! Parse all remaining values. Existing values of destination are not overwritten.
+    void take_all(global_config_storage_t* out);
+
+   private:
+    string_view _str(uint64_t offset, uint64_t length) const { return text.substr(offset, length); }
+    bool _parse(string_view registry, string_view key, string_view value, nlohmann::json* out) const;
+};
+
+bool index_config_source(lazy_config_source* source);
+bool load_config_source(string_view path, bool use_mmap, lazy_config_source* source);
+void write_binary_config(global_config_storage_t const& all, std::streambuf* out);
+}  // namespace _configs
+
+static auto _g_lazy_source() noexcept
 {
     static std::mutex _lock;
-    static global_config_storage_t _storage;
+    static unique_ptr<_configs::lazy_config_source> _source;
+
+    return pair{std::unique_lock{_lock}, &_source};
+}
+
+static bool _lazy_take(string_view registry, string_view key, nlohmann::json* out)
+{
+    auto [_, p_source] = _g_lazy_source();
+    return *p_source && (*p_source)->take(registry, key, out);
+}
+
+static void _lazy_take_registry(string_view registry, config_registry_storage_t* out)
+{
+    auto [_, p_source] = _g_lazy_source();
+    if (*p_source) { (*p_source)->take_registry(registry, out); }
+}
+
+//! Materialize every remaining value to global storage, then release the source.
+static void _lazy_flush_all()
+{
+    unique_ptr<_configs::lazy_config_source> source;
+    {
+        auto [_, p_source] = _g_lazy_source();
+        source = move(*p_source);
+    }
+
+    if (not source) { return; }
+
+    global_config_storage_t all;
+    source->take_all(&all);
 
-    return pair{std::unique_lock{_lock}, &_storage};
+    // Existing values of global storage are not overwritten.
+    for (auto& [registry, section] : all) {
+        auto [_, p_shard] = _g_config(registry);
+        auto& dst = (*p_shard)[registry];
+
+        for (auto& [key, value] : section)
+            dst.try_emplace(key, move(value));
+    }
 }
 
 void config_registry::backend_t::_register_to_global_repo()
@@ -460,25 +1201,17 @@ void config_registry::backend_t::_register_to_global_repo()
         return;
 
     // If registry or any element is missing from global storage, merge on it.
-    if (auto [_, p_conf] = _g_config(); not find_ptr(*p_conf, _name))
+    if (auto [_, p_conf] = _g_config(_name); not find_ptr(*p_conf, _name))
         _owner->export_to(&(*p_conf)[_name]);
 
-    // Register to global repository
-    for (;;) {
-        auto [lock, repo] = _global_repo();
-        auto is_new = repo->try_emplace(_id, _owner->weak_from_this()).second;
-
-        if (not is_new) {
-            CPPH_WARN(
-                    "Waiting for registry '{}' unregistered from global registry.\n"
-                    "This might cause deadlock if you don't unregister another\n"
-                    " repository that has same name.");
-            std::this_thread::sleep_for(1s);
-            continue;
-        }
+    // Register to global repository. Ids never collide, thus this never blocks update().
+    {
+        auto [lock, shard] = _global_repo(_name);
+        auto is_new = shard->storage.try_emplace(_id, _owner->weak_from_this()).second;
+        assert(is_new && "Registry must be registered exactly once.");
+        (void)is_new;
 
         release(_is_registered, true);
-        break;
     }
 
     g_evt_registered.invoke(_owner->shared_from_this());
@@ -495,83 +1228,120 @@ bool config_registry::backend_t::_handle_structure_update()
         // Check for deletions
         for (auto& wp : _config_removed) {
             if (auto conf = wp.lock()) {
-                _configs.erase(conf->_id);  // Erase from 'all' list
+                if (auto ctx = _find_slot(conf->_id)) { _release_slot(ctx); }  // Erase from 'all' list
                 has_structure_change = true;
             }
         }
 
-        // Check for additions
+        // Check for additions. Key index is maintained incrementally.
         for (auto& [wp, tup] : config_added) {
             if (auto conf = wp.lock()) {
                 auto& [sort_order] = tup;
-                if (not conf) { continue; }
 
-                auto [iter, is_new] = _configs.try_emplace(conf->id());
-                assert(is_new || ptr_equals(iter->second.reference, conf) && "Reference must not change!");
+                auto ctx = _find_slot(conf->id());
+                auto is_new = ctx == nullptr;
+                assert(is_new || ptr_equals(ctx->reference, conf) && "Reference must not change!");
                 has_structure_change |= is_new;
 
-                auto& [key, ctx] = *iter;
+                if (is_new) { ctx = _acquire_slot(conf->id()); }
 
-                ctx.reference = conf;
-                ctx.sort_order = sort_order;
-                ctx.full_key_cached = conf->full_key();
+                ctx->reference = conf;
+                ctx->sort_order = sort_order;
+                _own_key(ctx, conf->_key.load(std::memory_order_acquire));
             }
         }
 
-        // Rebuild config id mappings
-        _key_id_table.clear();
-        for (auto& [key, ctx] : _configs) {
-            _key_id_table.try_emplace(ctx.full_key_cached, key);
-        }
-
         _config_removed.clear();
     }
 
     // Performs initial loading on adding new storage ...
-    optional<config_registry_storage_t> storage;
-    struct rw_context_t {
-        string str;
-        streambuf::stringbuf sbuf{&str};
-        archive::msgpack::writer wr{&sbuf};
-        archive::msgpack::reader rd{&sbuf};
-    };
-    optional<rw_context_t> rw;
+    //  Section of this registry is modified in place, under protection of its shard lock.
+    //  Loaded values are committed after the lock is released, as commit invokes user
+    //  validators which may access global storage by themselves.
+    vector<pair<config_base_ptr, nlohmann::json>> loaded;
+    {
+        std::unique_lock<std::mutex> shard_lock;
+        config_registry_storage_t* storage = nullptr;
+        _configs::json_dom_writer writer;
 
-    for (auto& [wp, tup] : config_added) {
-        auto conf = wp.lock();
-        if (not conf) { continue; }
+        for (auto& [wp, tup] : config_added) {
+            auto conf = wp.lock();
+            if (not conf) { continue; }
 
-        if (not storage) {
-            auto [_, g_config] = _g_config();
+            if (not storage) {
+                auto [lock, g_config] = _g_config(_name);
+                shard_lock = move(lock);
+                storage = &(*g_config)[_name];
+            }
 
-            if (auto p_storage = find_ptr(*g_config, _name))
-                storage = p_storage->second;
-            else
-                storage.emplace();  // There's no storage for this config registry ...
-        }
+            auto full_key = conf->full_key();
+            auto data = find_ptr(*storage, full_key);
 
-        if (not rw) { rw.emplace(); }
-        rw->sbuf.clear();
-        rw->wr.clear(), rw->rd.clear();
+            if (nlohmann::json value; not data && _lazy_take(_name, full_key, &value)) {
+                // Materialize value from imported file, only when it's actually required.
+                data = &*storage->insert_or_assign(string{full_key}, move(value)).first;
+            }
 
-        if (auto data = find_ptr(*storage, conf->full_key())) {
-            // Load existing value ...
-            (rw->wr << data->second).flush();
-            bk_commit(conf.get(), &rw->rd);
-        } else {
-            // Init with default value ...
-            (rw->wr << conf->_body.raw_data.view()).flush();
-            try {
-                rw->rd >> (*storage)[conf->full_key()];
-            } catch (std::exception& e) {
-                CPPH_ERROR("Error dumping json object");
+            if (data) {
+                // Load existing value ...
+                loaded.emplace_back(move(conf), data->second);
+            } else {
+                // Init with default value ...
+                auto iter = storage->try_emplace(string{full_key}).first;
+                writer.reset(&iter->second);
+
+                try {
+                    writer << conf->_body.raw_data.view();
+                } catch (std::exception& e) {
+                    CPPH_ERROR("Error dumping json object");
+                    storage->erase(iter);
+                }
             }
         }
     }
 
-    if (storage) {
-        auto [lc, p_cfg] = _g_config();
-        (*p_cfg)[_name] = move(*storage);
+    _configs::json_dom_reader reader;
+
+    for (auto& [conf, value] : loaded) {
+        reader.reset(&value);
+        bk_commit(conf.get(), &reader, {}, "file");
+    }
+
+    // Environment values are parsed as json. If it fails, or the config doesn't accept
+    //  parsed one, the raw string is used instead. Candidates are validated here even if
+    //  the config validates asynchronously, as rejection must be known to fall back.
+    auto fn_try_env = [&](config_base* conf, nlohmann::json const& json) {
+        auto object = conf->attribute()->fn_construct();
+
+        try {
+            reader.reset(&json);
+            reader >> object.view();
+        } catch (std::exception&) {
+            return false;
+        }
+
+        return attribute_validate(*conf->attribute(), object.view())
+            && _commit(conf, move(object), {}, "env");
+    };
+
+    auto fn_commit_env = [&](config_base* conf, string const& value) {
+        auto json = nlohmann::json::parse(value, nullptr, false);
+        if (not json.is_discarded() && not json.is_string() && fn_try_env(conf, json)) { return; }
+
+        if (not fn_try_env(conf, value))
+            CPPH_WARN("Config Repo '{}': Invalid environment value for '{}'", _name, conf->full_key());
+    };
+
+    for (auto& [wp, tup] : config_added) {
+        auto conf = wp.lock();
+        if (not conf) { continue; }
+
+        // Environment binding overrides file value, as it's committed later. Flags parsed by
+        //  configs_parse_args() are committed after this, thus they override both.
+        if (auto& env = conf->attribute()->env_binding; not env.empty()) {
+            if (auto value = find_ptr(_configs::environment_snapshot(), env))
+                fn_commit_env(conf.get(), value->second);
+        }
     }
 
     return has_structure_change;
@@ -580,39 +1350,30 @@ bool config_registry::backend_t::_handle_structure_update()
 bool config_registry::import_from(config_registry_storage_t const& from, string* buf)
 {
     auto& s = *_self;
-    map<string, config_base_ptr> key_conf_table;
+    map<string_view, config_base_ptr> key_conf_table;
 
     // Clone key to id table
     {
         CPPH_TMPVAR{std::shared_lock{s._mtx_access}};
-        for (auto& [key, id] : s._key_id_table)
-            if (auto elem = find_ptr(s._configs, id))
-                if (auto ref = elem->second.reference.lock())
-                    key_conf_table[key] = ref;
+        for (auto& [key, owners] : s._key_owners)
+            if (auto ctx = s._find_slot(owners.owner))
+                if (auto ref = ctx->reference.lock())
+                    key_conf_table[key->str] = ref;
     }
 
-    string buf_body;
-    if (buf == nullptr) { buf = &buf_body; }
-
-    // Prepare context
-    buf->clear();
-    streambuf::stringbuf sbuf{buf};
-    archive::msgpack::writer writer{&sbuf};
-    archive::msgpack::reader reader{&sbuf};
+    (void)buf;  // Not used anymore; values are read directly from json.
+    _configs::json_dom_reader reader;
 
     for (auto& [key, json] : from) {
         auto p_conf = find_ptr(key_conf_table, key);
         if (not p_conf || not p_conf->second->can_import()) { continue; }  // Missing element
 
-        // Clear context
-        sbuf.clear(), writer.clear(), reader.clear();
-
-        // Serialize JSON data
-        writer << json;
-        writer.flush();
+        // Environment binding keeps its precedence over file, on every import.
+        if (auto& env = p_conf->second->attribute()->env_binding;
+            not env.empty() && find_ptr(_configs::environment_snapshot(), env)) { continue; }
 
-        // Retrieve from dumped json content, and commit
-        s.bk_commit(p_conf->second.get(), &reader);
+        reader.reset(&json);
+        s.bk_commit(p_conf->second.get(), &reader, {}, "file");
     }
 
     return false;
@@ -622,39 +1383,61 @@ void config_registry::export_to(config_registry_storage_t* to, string* buf) cons
 {
     auto& s = *_self;
 
-    string buf_body;
-    if (buf == nullptr) { buf = &buf_body; }
+    (void)buf;  // Not used anymore; values are written directly to json.
+    _configs::json_dom_writer writer;
 
     // Export must be performed inside 'access protected' scope.
     CPPH_TMPVAR{std::shared_lock{s._mtx_access}};
 
-    // Filled with msgpack raw binary
-    buf->clear();
-    streambuf::stringbuf sbuf{buf};
-    archive::msgpack::writer writer{&sbuf};
-    archive::msgpack::reader reader{&sbuf};
-
-    for (auto& [key, ctx] : s._configs) {
+    s._for_each_slot([&](config_entity_context const& ctx) {
         auto cfg = ctx.reference.lock();
-        if (not cfg || not cfg->can_export()) { continue; }
+        if (not cfg || not cfg->can_export()) { return; }
 
-        // Clear context
-        sbuf.clear(), writer.clear(), reader.clear();
+        // Key string is only allocated when destination doesn't have it yet.
+        auto iter = to->find(ctx.full_key_cached);
+        if (iter == to->end()) { iter = to->try_emplace(string{ctx.full_key_cached}).first; }
+
+        writer.reset(&iter->second);
 
-        // cfg -> msgpack -> nlohmann::json
         // If it has staged value, prefer it here.
         if (ctx._staged) {
             writer << ctx._staged.view();
         } else {
             writer << cfg->_body.raw_data.view();
         }
+    });
+}
+
+void config_registry::strip_defaults(config_registry_storage_t* from) const
+{
+    auto& s = *_self;
+
+    _configs::json_dom_writer writer;
+    nlohmann::json default_value;
+
+    CPPH_TMPVAR{std::shared_lock{s._mtx_access}};
+
+    s._for_each_slot([&](config_entity_context const& ctx) {
+        auto cfg = ctx.reference.lock();
+        if (not cfg) { return; }
+
+        auto iter = from->find(ctx.full_key_cached);
+        if (iter == from->end()) { return; }
+
+        try {
+            writer.reset(&default_value);
+            writer << cfg->default_value().view();
+        } catch (std::exception& e) {
+            CPPH_ERROR("Error dumping default value of '{}': {}", ctx.full_key_cached, e.what());
+            return;
+        }
 
-        writer.flush();
-        reader >> (*to)[ctx.full_key_cached];
-    }
+        if (iter->second == default_value)
+            from->erase(iter);
+    });
 }
 
-void configs_export(global_config_storage_t* json_dst, bool merge)
+void configs_export(global_config_storage_t* json_dst, bool merge, bool non_default_only)
 {
     //  Iterate registries, merge to existing global, copy to json_dst.
     vector<config_registry_ptr> repos;
@@ -663,28 +1446,52 @@ void configs_export(global_config_storage_t* json_dst, bool merge)
     json_dst->clear();
 
     if (merge) {
-        auto [_, p_all] = _g_config();
-        *json_dst = *p_all;
+        // Values which are not yet materialized should also be exported.
+        _lazy_flush_all();
+
+        _g_config_for_each([&](global_config_storage_t* p_shard) {
+            json_dst->insert(p_shard->begin(), p_shard->end());
+        });
+    } else {
+        // Discard imported contents, as global storage will be replaced with alive ones.
+        auto [_, p_source] = _g_lazy_source();
+        p_source->reset();
     }
 
-    // Copy existing global configs to destination
-    string buffer_;
-    {
-        // Collect all alive registries' configs
+    // Collect all alive registries' configs
+    for (auto& repo : repos) {
+        repo->export_to(&(*json_dst)[repo->name()]);
+    }
+
+    // Update existing global configs with new entries. On merge, only alive registries'
+    //  sections can be changed.
+    if (merge) {
         for (auto& repo : repos) {
-            repo->export_to(&(*json_dst)[repo->name()], &buffer_);
+            if (auto p_section = find_ptr(*json_dst, repo->name())) {
+                auto [_, p_shard] = _g_config(repo->name());
+                (*p_shard)[repo->name()] = p_section->second;
+            }
         }
+    } else {
+        _g_config_assign(*json_dst);
     }
 
-    // Update existing global configs with new entries
-    {
-        auto [_, p_all] = _g_config();
-        *p_all = *json_dst;
+    // Global storage always keeps full content, thus defaults are stripped after update.
+    if (non_default_only) {
+        for (auto& repo : repos)
+            if (auto p_section = find_ptr(*json_dst, repo->name()))
+                repo->strip_defaults(&p_section->second);
     }
 }
 
 void configs_import(global_config_storage_t json_content)
 {
+    // Previously imported contents are replaced.
+    {
+        auto [_, p_source] = _g_lazy_source();
+        p_source->reset();
+    }
+
     // Import json content
     {
         vector<config_registry_ptr> repos;
@@ -694,64 +1501,675 @@ void configs_import(global_config_storage_t json_content)
         sort(repos, [](auto&& a, auto&& b) { return a->name() < b->name(); });
 
         // Import configs
-        string buffer_;
         for (auto const& [key, content] : json_content) {
             auto iter = lower_bound(repos, key, [](auto&& a, auto&& b) { return a->name() < b; });
             if (iter == repos.end() || (**iter).name() != key) { continue; }  // could not found.
 
-            (**iter).import_from(content, &buffer_);
+            (**iter).import_from(content);
             (**iter).backend()->bk_notify();  // Notify update
         }
     }
 
     // Copy content with existing globals
-    {
-        auto [_, p_all] = _g_config();
-        *p_all = move(json_content);
-    }
+    _g_config_assign(move(json_content));
 }
 }  // namespace perfkit::v2
 
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
 
+#if __unix__
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#elif defined(_WIN32)
+#    include <io.h>
+#    include <process.h>
+#endif
+
 namespace perfkit::v2 {
-bool configs_export(string_view path, bool merge)
+namespace _configs {
+lazy_config_source::~lazy_config_source() noexcept
 {
-    global_config_storage_t all;
-    configs_export(&all, merge);
+#if __unix__
+    if (mapped_addr) { munmap(mapped_addr, mapped_size); }
+#endif
+}
 
-    std::ofstream fs{string{path}};
+bool lazy_config_source::_parse(string_view registry, string_view key, string_view value, nlohmann::json* out) const
+{
+    try {
+        if (is_binary())
+            *out = nlohmann::json::from_msgpack(value.begin(), value.end());
+        else
+            *out = nlohmann::json::parse(value);
+
+        return true;
+    } catch (std::exception& e) {
+        CPPH_ERROR("Parse error from config '{}' of '{}': {}", key, registry, e.what());
+        return false;
+    }
+}
+
+bool lazy_config_source::take(string_view registry, string_view key, nlohmann::json* out)
+{
+    if (is_binary()) {
+        // Entries are sorted by (registry, key), thus binary search can be applied directly.
+        auto iter = std::lower_bound(
+                entries.begin(), entries.end(), pair{registry, key},
+                [this](binary_config_entry const& e, auto const& k) {
+                    return pair{_str(e.registry_offset, e.registry_length), _str(e.key_offset, e.key_length)} < k;
+                });
+
+        if (iter == entries.end()) { return false; }
+        if (_str(iter->registry_offset, iter->registry_length) != registry) { return false; }
+        if (_str(iter->key_offset, iter->key_length) != key) { return false; }
+
+        auto index = iter - entries.begin();
+        if (entry_taken[index]) { return false; }
+
+        entry_taken[index] = true;
+        return _parse(registry, key, _str(iter->value_offset, iter->value_length), out);
+    }
+
+    auto p_section = find_ptr(index, registry);
+    if (not p_section) { return false; }
+
+    auto& section = p_section->second;
+    auto p_value = find_ptr(section, key);
+    if (not p_value) { return false; }
+
+    bool succeeded = _parse(registry, key, p_value->second, out);
+
+    section.erase(section.find(key));
+    if (section.empty()) { index.erase(index.find(registry)); }
+
+    return succeeded;
+}
+
+void lazy_config_source::take_registry(string_view registry, config_registry_storage_t* out)
+{
+    nlohmann::json value;
+
+    if (is_binary()) {
+        auto [begin, end] = std::equal_range(
+                entries.begin(), entries.end(), registry,
+                [this](auto const& a, auto const& b) {
+                    if constexpr (std::is_same_v<std::decay_t<decltype(a)>, string_view>)
+                        return a < _str(b.registry_offset, b.registry_length);
+                    else
+                        return _str(a.registry_offset, a.registry_length) < b;
+                });
+
+        for (auto iter = begin; iter != end; ++iter) {
+            auto index = iter - entries.begin();
+            if (entry_taken[index]) { continue; }
+
+            entry_taken[index] = true;
+            auto key = _str(iter->key_offset, iter->key_length);
+
+            if (_parse(registry, key, _str(iter->value_offset, iter->value_length), &value))
+                (*out)[string{key}] = move(value);
+        }
+
+        return;
+    }
+
+    auto p_section = find_ptr(index, registry);
+    if (not p_section) { return; }
+
+    for (auto& [key, text] : p_section->second)
+        if (_parse(registry, key, text, &value))
+            (*out)[string{key}] = move(value);
+
+    index.erase(index.find(registry));
+}
+
+void lazy_config_source::take_all(global_config_storage_t* out)
+{
+    nlohmann::json value;
+
+    if (is_binary()) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entry_taken[i]) { continue; }
+
+            auto& e = entries[i];
+            auto registry = _str(e.registry_offset, e.registry_length);
+            auto key = _str(e.key_offset, e.key_length);
+
+            if (_parse(registry, key, _str(e.value_offset, e.value_length), &value))
+                (*out)[string{registry}].try_emplace(string{key}, move(value));
+        }
+
+        entry_taken.assign(entries.size(), true);
+        return;
+    }
+
+    for (auto& [registry, section] : index)
+        for (auto& [key, text] : section)
+            if (_parse(registry, key, text, &value))
+                (*out)[string{registry}].try_emplace(string{key}, move(value));
+
+    index.clear();
+}
+
+static bool index_binary_config_source(lazy_config_source* source)
+{
+    auto& text = source->text;
+    binary_config_header header;
+
+    if (text.size() < sizeof header) { return false; }
+    memcpy(&header, text.data(), sizeof header);
+
+    if (memcmp(header.magic, binary_config_magic, sizeof header.magic) != 0) { return false; }
+    if (header.version != binary_config_version) { return false; }
+    if (header.endian_mark != binary_config_endian_mark) { return false; }
+    if (header.entry_offset % alignof(binary_config_entry) != 0) { return false; }
+
+    // Compare by division, as multiplying untrusted entry count may wrap around.
+    if (header.entry_offset > text.size()) { return false; }
+    if (header.num_entries > (text.size() - header.entry_offset) / sizeof(binary_config_entry)) { return false; }
+
+    // Entry table is referred in-place, without any copy.
+    source->entries = {reinterpret_cast<binary_config_entry const*>(text.data() + header.entry_offset),
+                       size_t(header.num_entries)};
+
+    for (auto& e : source->entries) {
+        auto fn_in_range = [&](uint64_t ofst, uint64_t len) { return ofst <= text.size() && len <= text.size() - ofst; };
+        if (not fn_in_range(e.registry_offset, e.registry_length)
+            || not fn_in_range(e.key_offset, e.key_length)
+            || not fn_in_range(e.value_offset, e.value_length)) {
+            source->entries = {};
+            return false;
+        }
+    }
+
+    source->entry_taken.assign(source->entries.size(), false);
+    return true;
+}
+
+void write_binary_config(global_config_storage_t const& all, std::streambuf* out)
+{
+    vector<binary_config_entry> entries;
+    string blob;
+
+    for (auto& [registry, section] : all) {
+        auto registry_offset = blob.size();
+        blob += registry;
+
+        // As both levels of the storage are sorted maps, entries are already sorted.
+        for (auto& [key, value] : section) {
+            auto& e = entries.emplace_back();
+            e.registry_offset = registry_offset;
+            e.registry_length = registry.size();
+
+            e.key_offset = blob.size();
+            e.key_length = key.size();
+            blob += key;
+
+            auto packed = nlohmann::json::to_msgpack(value);
+            e.value_offset = blob.size();
+            e.value_length = packed.size();
+            blob.append(packed.begin(), packed.end());
+        }
+    }
+
+    binary_config_header header = {};
+    memcpy(header.magic, binary_config_magic, sizeof header.magic);
+    header.version = binary_config_version;
+    header.endian_mark = binary_config_endian_mark;
+    header.num_entries = entries.size();
+    header.entry_offset = sizeof header;
+
+    // Make offsets absolute
+    auto blob_offset = header.entry_offset + entries.size() * sizeof(binary_config_entry);
+    for (auto& e : entries) {
+        e.registry_offset += blob_offset;
+        e.key_offset += blob_offset;
+        e.value_offset += blob_offset;
+    }
+
+    out->sputn((char const*)&header, sizeof header);
+    out->sputn((char const*)entries.data(), entries.size() * sizeof(binary_config_entry));
+    out->sputn(blob.data(), blob.size());
+}
+
+bool load_config_source(string_view path, bool use_mmap, lazy_config_source* source)
+{
+#if __unix__
+    if (use_mmap) {
+        int fd = open(string{path}.c_str(), O_RDONLY);
+        if (fd == -1) { return false; }
+
+        struct stat st = {};
+        void* addr = MAP_FAILED;
+
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+            addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        close(fd);
+
+        if (addr != MAP_FAILED) {
+            source->mapped_addr = addr;
+            source->mapped_size = st.st_size;
+            source->text = {(char const*)addr, source->mapped_size};
+            return true;
+        }
+
+        // Fallback to normal read on mapping failure, e.g. empty file.
+    }
+#endif
+
+    std::ifstream fs{string{path}, std::ios::binary};
     if (not fs.is_open()) { return false; }
 
+    source->content.assign(std::istreambuf_iterator<char>{fs}, std::istreambuf_iterator<char>{});
+    source->text = source->content;
+    return true;
+}
+
+namespace {
+/**
+ * Minimal json scanner, which only finds out boundaries of values without parsing them.
+ */
+class json_scanner
+{
+    string_view _s;
+    size_t _pos = 0;
+
+   public:
+    explicit json_scanner(string_view s) noexcept : _s(s) {}
+
+    bool done() { return _skip_ws(), _pos >= _s.size(); }
+
+    bool consume(char c)
     {
-        archive::json::writer writer{fs.rdbuf()};
-        writer.indent = 2;
-        writer << all;
+        _skip_ws();
+        if (_pos < _s.size() && _s[_pos] == c) { return ++_pos, true; }
+        return false;
+    }
+
+    //! Unescaped strings refer to source directly. Otherwise, decoded string is stored to 'owned'.
+    bool read_string(string_view* out, std::list<string>* owned)
+    {
+        _skip_ws();
+        auto begin = _pos;
+        if (not _skip_string()) { return false; }
+
+        auto token = _s.substr(begin, _pos - begin);
+        if (token.find('\\') == string_view::npos) {
+            *out = token.substr(1, token.size() - 2);
+            return true;
+        }
+
+        // Only escaped strings go through actual parser
+        try {
+            *out = owned->emplace_back(nlohmann::json::parse(token).get<string>());
+            return true;
+        } catch (std::exception&) {
+            return false;
+        }
+    }
+
+    bool skip_value(string_view* out)
+    {
+        _skip_ws();
+        auto begin = _pos;
+        if (_pos >= _s.size()) { return false; }
+
+        if (_s[_pos] == '"') {
+            if (not _skip_string()) { return false; }
+        } else if (_s[_pos] == '{' || _s[_pos] == '[') {
+            int depth = 0;
+
+            while (_pos < _s.size()) {
+                auto c = _s[_pos];
+
+                if (c == '"') {
+                    if (not _skip_string()) { return false; }
+                    continue;
+                }
+
+                ++_pos;
+                if (c == '{' || c == '[') {
+                    ++depth;
+                } else if ((c == '}' || c == ']') && --depth == 0) {
+                    break;
+                }
+            }
+
+            if (depth != 0) { return false; }
+        } else {
+            // Number or literal
+            while (_pos < _s.size() && not strchr(",}] \t\r\n", _s[_pos])) { ++_pos; }
+        }
+
+        *out = _s.substr(begin, _pos - begin);
+        return not out->empty();
     }
 
+   private:
+    void _skip_ws()
+    {
+        while (_pos < _s.size() && isspace((unsigned char)_s[_pos])) { ++_pos; }
+    }
+
+    bool _skip_string()
+    {
+        if (_pos >= _s.size() || _s[_pos] != '"') { return false; }
+
+        for (++_pos; _pos < _s.size(); ++_pos) {
+            if (_s[_pos] == '\\') {
+                ++_pos;
+            } else if (_s[_pos] == '"') {
+                return ++_pos, true;
+            }
+        }
+
+        return false;
+    }
+};
+}  // namespace
+
+bool index_config_source(lazy_config_source* source)
+{
+    auto& text = source->text;
+    if (text.size() >= sizeof binary_config_magic
+        && memcmp(text.data(), binary_config_magic, sizeof binary_config_magic) == 0) {
+        return index_binary_config_source(source);
+    }
+
+    json_scanner scan{text};
+    string_view registry, key, value;
+
+    if (not scan.consume('{')) { return false; }
+
+    if (not scan.consume('}')) {
+        do {
+            if (not scan.read_string(&registry, &source->owned_keys) || not scan.consume(':')) { return false; }
+            if (not scan.consume('{')) { return false; }
+
+            auto& section = source->index[registry];
+            if (scan.consume('}')) { continue; }
+
+            do {
+                if (not scan.read_string(&key, &source->owned_keys) || not scan.consume(':')) { return false; }
+                if (not scan.skip_value(&value)) { return false; }
+
+                section.insert_or_assign(key, value);
+            } while (scan.consume(','));
+
+            if (not scan.consume('}')) { return false; }
+        } while (scan.consume(','));
+
+        if (not scan.consume('}')) { return false; }
+    }
+
+    return scan.done();
+}
+}  // namespace _configs
+
+static bool is_binary_config_path(string_view path)
+{
+    constexpr string_view ext = ".pkcfg";
+    return path.size() >= ext.size() && path.substr(path.size() - ext.size()) == ext;
+}
+
+namespace _configs {
+//! Write content and flush it to the storage device, before the file is renamed.
+static bool write_file_synced(string const& path, string_view content)
+{
+    auto fp = fopen(path.c_str(), "wb");
+    if (not fp) { return false; }
+
+    bool ok = fwrite(content.data(), 1, content.size(), fp) == content.size();
+    ok = ok && fflush(fp) == 0;
+#if __unix__
+    ok = ok && fsync(fileno(fp)) == 0;
+#elif defined(_WIN32)
+    ok = ok && _commit(_fileno(fp)) == 0;
+#endif
+
+    return fclose(fp) == 0 && ok;
+}
+
+//! Check if file on storage consists of exactly given content.
+static bool file_content_equals(string const& path, string_view content)
+{
+    auto fp = fopen(path.c_str(), "rb");
+    if (not fp) { return false; }
+
+    char buf[4096];
+    size_t pos = 0;
+    bool equal = true;
+
+    while (equal) {
+        auto n = fread(buf, 1, sizeof buf, fp);
+        if (n == 0) { break; }
+
+        equal = n <= content.size() - pos && memcmp(buf, content.data() + pos, n) == 0;
+        pos += n;
+    }
+
+    equal = equal && not ferror(fp) && pos == content.size();
+    fclose(fp);
+    return equal;
+}
+
+//! Make rename of directory entry durable. No-op on platforms without directory sync.
+static void sync_parent_directory(string_view path)
+{
+#if __unix__
+    auto dir = std::filesystem::path{path}.parent_path();
+    if (dir.empty()) { dir = "."; }
+
+    if (int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY); fd != -1) {
+        fsync(fd);
+        close(fd);
+    }
+#endif
+}
+
+static auto current_process_id() noexcept
+{
+#if __unix__
+    return int64_t(getpid());
+#elif defined(_WIN32)
+    return int64_t(_getpid());
+#else
+    return int64_t(0);
+#endif
+}
+}  // namespace _configs
+
+/**
+ * Replace config file atomically. Returns false only on failure; writing is skipped if content
+ *  is identical with the one that was previously written to the same path.
+ */
+static bool write_config_file(string_view path, global_config_storage_t const& all)
+{
+    namespace fs = std::filesystem;
+
+    string content;
+    {
+        streambuf::stringbuf out;
+
+        if (is_binary_config_path(path)) {
+            _configs::write_binary_config(all, &out);
+        } else {
+            archive::json::writer writer{&out};
+            writer.indent = 2;
+            writer << all;
+        }
+
+        content = move(out.str());
+    }
+
+    static std::mutex lock;
+    static map<string, size_t, std::less<>> written_hashes;
+
+    auto hash = std::hash<string_view>{}(content);
+    std::error_code ec;
+
+    CPPH_TMPVAR{lock_guard{lock}};
+
+    if (auto p_hash = find_ptr(written_hashes, path); p_hash && p_hash->second == hash) {
+        // Still, file can be modified or removed by others, even keeping its size.
+        if (_configs::file_content_equals(p_hash->first, content)) {
+            CPPH_DEBUG("Config file '{}' is up to date. Skipping write.", path);
+            return true;
+        }
+    }
+
+    // Temporary file name is unique per process, as other processes may export to same path.
+    auto tmp_path = fmt::format("{}.{}.tmp", path, _configs::current_process_id());
+
+    if (not _configs::write_file_synced(tmp_path, content)) {
+        CPPH_ERROR("Failed to write config file '{}'", tmp_path);
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+
+    // Interrupted export never leaves truncated file, as rename() replaces file atomically,
+    //  and its content is already synced to storage before the rename.
+    fs::rename(tmp_path, fs::path{path}, ec);
+    if (ec) {
+        CPPH_ERROR("Failed to replace config file '{}': {}", path, ec.message());
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+
+    _configs::sync_parent_directory(path);
+
+    written_hashes.insert_or_assign(string{path}, hash);
+    return true;
+}
+
+bool configs_export(string_view path, bool merge, bool non_default_only)
+{
+    global_config_storage_t all;
+    configs_export(&all, merge, non_default_only);
+
+    if (not write_config_file(path, all)) { return false; }
+
     CPPH_INFO("Config exported to '{}'", path);
     return true;
 }
 
-bool configs_import(string_view path)
+bool configs_convert(string_view src_path, string_view dst_path)
 {
+    _configs::lazy_config_source source;
+    if (not _configs::load_config_source(src_path, false, &source)) { return false; }
+
+    if (not _configs::index_config_source(&source)) {
+        CPPH_ERROR("Parse error from config {}", src_path);
+        return false;
+    }
+
     global_config_storage_t all;
+    source.take_all(&all);
 
-    std::ifstream fs{string{path}};
-    if (not fs.is_open()) { return false; }
+    if (not write_config_file(dst_path, all)) { return false; }
 
-    try {
-        archive::json::reader{fs.rdbuf()} >> all;
-    } catch (std::exception& e) {
+    CPPH_INFO("Config converted from '{}' to '{}'", src_path, dst_path);
+    return true;
+}
+
+bool configs_import(string_view path, bool use_mmap)
+{
+    auto source = make_unique<_configs::lazy_config_source>();
+    if (not _configs::load_config_source(path, use_mmap, source.get())) { return false; }
+
+    if (not _configs::index_config_source(source.get())) {
         CPPH_ERROR("Parse error from config {}", path);
         return false;
     }
 
-    configs_import(move(all));
+    // Replace existing contents with lazy source.
+    _g_config_for_each([](global_config_storage_t* p_shard) { p_shard->clear(); });
+    {
+        auto [_, p_source] = _g_lazy_source();
+        *p_source = move(source);
+    }
+
+    // Registries that are already alive should be loaded immediately.
+    vector<config_registry_ptr> repos;
+    config_registry::backend_t::bk_enumerate_registries(&repos);
+
+    for (auto& repo : repos) {
+        config_registry_storage_t content;
+        _lazy_take_registry(repo->name(), &content);
+        if (content.empty()) { continue; }
+
+        repo->import_from(content);
+        repo->backend()->bk_notify();
+
+        auto [_, p_shard] = _g_config(repo->name());
+        (*p_shard)[repo->name()] = move(content);
+    }
+
     CPPH_INFO("Config successfully imported from '{}'", path);
     return true;
 }
 
+bool configs_reload(string_view path)
+{
+    _configs::lazy_config_source source;
+    if (not _configs::load_config_source(path, false, &source)) { return false; }
+
+    if (not _configs::index_config_source(&source)) {
+        CPPH_ERROR("Parse error from config {}", path);
+        return false;
+    }
+
+    global_config_storage_t loaded;
+    source.take_all(&loaded);
+
+    // Collect keys which are actually changed since last load or export
+    global_config_storage_t changes;
+    size_t num_changes = 0;
+    for (auto& [registry, section] : loaded) {
+        auto [_, p_shard] = _g_config(registry);
+        auto& current = (*p_shard)[registry];
+
+        for (auto& [key, value] : section) {
+            auto p_value = find_ptr(current, key);
+
+            // Pending value of previous import is taken only when the new file has same key,
+            //  thus the other values remain lazy.
+            if (nlohmann::json prev; not p_value && _lazy_take(registry, key, &prev))
+                p_value = &*current.insert_or_assign(key, move(prev)).first;
+
+            if (p_value && p_value->second == value)
+                continue;
+
+            changes[registry][key] = value;
+            current[key] = move(value);
+            ++num_changes;
+        }
+    }
+
+    if (changes.empty()) { return true; }
+
+    // Only changed values are committed to alive registries.
+    vector<config_registry_ptr> repos;
+    config_registry::backend_t::bk_enumerate_registries(&repos);
+
+    for (auto& repo : repos) {
+        auto p_changes = find_ptr(changes, repo->name());
+        if (not p_changes) { continue; }
+
+        // Env-bound configs are skipped by import_from(), thus environment keeps precedence.
+        repo->import_from(p_changes->second);
+        repo->backend()->bk_notify();
+    }
+
+    CPPH_INFO("{} config(s) reloaded from '{}'", num_changes, path);
+    return true;
+}
+
 auto configs_export_dump(int indent, bool merge) -> string
 {
     global_config_storage_t all;
@@ -768,8 +2186,34 @@ auto configs_export_dump(int indent, bool merge) -> string
 }
 
 namespace _configs {
+interned_key const* intern_key(string_view key)
+{
+    struct node_t {
+        string content;
+        interned_key key;
+    };
+
+    static std::mutex lock;
+    static std::unordered_map<string_view, unique_ptr<node_t>> table;
+
+    CPPH_TMPVAR{lock_guard{lock}};
+
+    if (auto p_node = find_ptr(table, key))
+        return &p_node->second->key;
+
+    auto node = make_unique<node_t>();
+    node->content = key;
+    node->key.str = node->content;
+    node->key.hash = std::hash<string_view>{}(key);
+
+    auto p_key = &node->key;
+    table.try_emplace(p_key->str, move(node));
+
+    return p_key;
+}
+
 void parse_full_key(
-        const string& full_key, string* o_display_key, vector<string_view>* o_hierarchy)
+        string_view full_key, string* o_display_key, vector<string_view>* o_hierarchy)
 {
     *o_display_key = full_key;
     o_hierarchy->clear();
@@ -37,10 +37,13 @@
 #include <spdlog/logger.h>
 #include <spdlog/spdlog.h>
 
+#include <nlohmann/json.hpp>
+
 #include "cpph/thread/locked.hxx"
 #include "cpph/utility/format.hxx"
 #include "perfkit/detail/base.hpp"
 #include "perfkit/detail/commands.hpp"
+#include "perfkit/detail/configs-v2-backend.hpp"
 #include "perfkit/detail/configs-v2.hpp"
 #include "perfkit/detail/tracer.hpp"
 
@@ -119,6 +122,110 @@ void register_conffile_io_commands(
     if (!node_load || !node_save) { throw command_already_exist_exception{}; }
 }
 
+void register_conffile_watch_command(if_terminal* ref, std::string_view cmd)
+{
+    auto watch = std::make_shared<std::shared_ptr<void>>();
+
+    auto node = ref->commands()->root()->add_subcommand(
+            std::string{cmd},
+            [watch](args_view args) {
+                if (args.size() > 1) { return false; }
+
+                // Previous watch is always released first.
+                watch->reset();
+                if (args.empty()) { return true; }
+
+                *watch = v2::configs_watch(args.front());
+                return *watch != nullptr;
+            },
+            [](auto&& tok, auto&& set) { return _config_saveload_manager::retrieve_filenames(tok, set); });
+
+    if (!node) { throw command_already_exist_exception{}; }
+}
+
+void register_config_history_command(if_terminal* ref, std::string_view cmd)
+{
+    using v2::config_registry;
+
+    auto fn_find_registry = [](std::string_view name) -> v2::config_registry_ptr {
+        std::vector<v2::config_registry_ptr> all;
+        config_registry::backend_t::bk_enumerate_registries(&all);
+
+        for (auto& rg : all)
+            if (rg->name() == name)
+                return rg;
+
+        return nullptr;
+    };
+
+    auto fn_dump_value = [](std::string_view msgpack) {
+        try {
+            return nlohmann::json::from_msgpack(msgpack.begin(), msgpack.end()).dump();
+        } catch (std::exception&) {
+            return std::string{"<invalid>"};
+        }
+    };
+
+    auto node = ref->commands()->root()->add_subcommand(
+            std::string{cmd},
+            [=](args_view args) {
+                if (args.empty()) { return false; }
+
+                std::string output;
+
+                auto rg = fn_find_registry(args[0]);
+                if (not rg) {
+                    output << "registry '{}' not found\n"_fmt % args[0];
+                    ref->write(output);
+                    return false;
+                }
+
+                if (args.size() == 3 && args[1] == "rollback") {
+                    char* end = nullptr;
+                    std::string fence_str{args[2]};
+                    size_t fence = std::strtoull(fence_str.c_str(), &end, 10);
+                    if (fence_str.empty() || *end != 0) { return false; }
+
+                    if (not rg->backend()->bk_rollback(fence)) {
+                        output << "cannot rollback '{}' to fence {}\n"_fmt % rg->name() % fence;
+                        ref->write(output);
+                        return false;
+                    }
+
+                    rg->backend()->bk_notify();
+                    return true;
+                } else if (args.size() != 1) {
+                    return false;
+                }
+
+                std::vector<v2::config_history_entry> history;
+                rg->backend()->bk_history(&history);
+
+                auto now = std::chrono::system_clock::now();
+
+                for (auto& entry : history) {
+                    auto elapsed = std::chrono::duration<double>(now - entry.timestamp).count();
+                    output << "[{:>6}] {:>10.1f}s ago ({}) {}: {} -> {}\n"_fmt
+                                      % entry.fence % elapsed % entry.source % entry.key
+                                      % fn_dump_value(entry.old_value())
+                                      % fn_dump_value(entry.new_value());
+                }
+
+                ref->write(output);
+                return true;
+            },
+            [](auto&& tok, auto&& set) {
+                if (tok.size() > 1) { return; }
+
+                std::vector<v2::config_registry_ptr> all;
+                config_registry::backend_t::bk_enumerate_registries(&all);
+
+                for (auto& rg : all) { set.emplace(rg->name()); }
+            });
+
+    if (!node) { throw command_already_exist_exception{}; }
+}
+
 void register_logging_manip_command(if_terminal* ref, std::string_view cmd)
 {
     std::string cmdstr{cmd};
@@ -208,14 +315,15 @@ class _trace_manip
 
     void help() const
     {
-        _ref->write("usage: <cmd> <tracer> [<regex filter> [true|false]]\n");
+        _ref->write("usage: <cmd> <tracer> [<regex filter> [true|false|folded]]\n");
     }
 
     void suggest(string_set& repos)
     {
         // list of tracers
-        for (auto const& tracer : tracer::all()) {
-            repos.insert(tracer->name());
+        for (auto const& wp : *tracer::all_snapshot()) {
+            if (auto tracer = wp.lock())
+                repos.insert(tracer->name());
         }
     }
 
@@ -242,10 +350,12 @@ class _trace_manip
 
         std::string pattern{".*"};
         std::optional<bool> setter;
+        bool folded = false;
 
         if (args.size() > 1) { pattern.assign(args[1].begin(), args[1].end()); }
         if (args.size() > 2) {
-            args[2] == "true" && (setter = true) || args[2] == "false" && (setter = false);
+            args[2] == "true" && (setter = true) || args[2] == "false" && (setter = false)
+                    || args[2] == "folded" && (folded = true);
         }
 
         using namespace ranges;
@@ -263,12 +373,12 @@ class _trace_manip
         }
 
         auto trc = *it;
-        _async = std::async(std::launch::async, [=] { _async_request(trc, pattern, setter); });
+        _async = std::async(std::launch::async, [=] { _async_request(trc, pattern, setter, folded); });
         return true;
     }
 
    private:
-    void _async_request(std::shared_ptr<tracer> ref, std::string pattern, std::optional<bool> setter)
+    void _async_request(std::shared_ptr<tracer> ref, std::string pattern, std::optional<bool> setter, bool folded)
     {
         std::promise<perfkit::tracer::fetched_traces> promise;
         auto fut = promise.get_future();
@@ -299,6 +409,24 @@ class _trace_manip
 
         using namespace ranges;
         std::regex match{pattern};
+
+        if (folded) {
+            // Flame graph input; filter applies to full key of each stack
+            std::string full_key;
+            auto fn_unmatched = [&](tracer::trace const& item) {
+                full_key.clear();
+                for (auto c : item.hierarchy | views::join("."sv)) { full_key += c; }
+                return not std::regex_match(full_key, match);
+            };
+
+            result.erase(std::remove_if(result.begin(), result.end(), fn_unmatched), result.end());
+
+            std::string output;
+            dump_folded_stacks(result, &output);
+            _ref->write(output);
+            return;
+        }
+
         std::string output;
         output << "\n"_fmt.s();
 
@@ -331,7 +459,14 @@ class _trace_manip
             }
 
             item.dump_data(data_str);
-            output << "{}= {}\n"_fmt % (item.subscribing() ? "(+) " : " ") % data_str;
+            output << "{}= {}"_fmt % (item.subscribing() ? "(+) " : " ") % data_str;
+
+            if (item.as_timer()) {
+                auto self_ms = std::chrono::duration<double, std::milli>{item.self_time}.count();
+                output << " (self {:.4f} ms){}"_fmt % self_ms % (item.on_critical_path ? " *" : "");
+            }
+
+            output << "\n"_fmt.s();
         }
 
         _ref->write(output);
@@ -27,10 +27,32 @@
 //
 #include "perfkit/detail/tracer.hpp"
 
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
 #include <future>
 #include <mutex>
+#include <numeric>
 #include <variant>
 
+#if __linux__
+#    include <pthread.h>
+#endif
+
+#if __linux__ && __has_include(<execinfo.h>)
+#    include <csignal>
+
+#    include <execinfo.h>
+#    define PERFKIT_STALL_CAPTURE 1
+#else
+#    define PERFKIT_STALL_CAPTURE 0
+#endif
+
+#ifndef PERFKIT_STALL_SIGNAL
+#    define PERFKIT_STALL_SIGNAL (SIGRTMIN + 6)
+#endif
+
+#include <fmt/ranges.h>
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/spdlog.h>
 
@@ -76,6 +98,7 @@ tracer::_entity_ty* tracer::_fork_branch(
     data.body.fence = _fence_active;
     data.body.active_order = _order_active++;
     _stack.push_back(&data);
+    _sync_stack_mirror(_stack.size() - 1);
 
     return &data;
 }
@@ -95,8 +118,7 @@ uint64_t tracer::_hash_active(_entity_ty const* parent, std::string_view top)
 
 tracer_proxy tracer::fork(std::string_view n, size_t interval)
 {
-    auto last_fork = _last_fork;
-    _last_fork = steady_clock::now();
+    auto last_fork = _last_fork.exchange(steady_clock::now(), std::memory_order_relaxed);
 
     if (_fence_active > _fence_latest)  // only when update exist...
         _deliver_previous_result();
@@ -107,10 +129,15 @@ tracer_proxy tracer::fork(std::string_view n, size_t interval)
     // Store current thread id
     _working_thread_id = std::this_thread::get_id();
 
+    // Plain fork() always starts non-accumulating iteration. fork_continuous() turns
+    //  continuous mode on again after this returns.
+    _is_continuous = false;
+
     // init new iteration
     ++_fence_active;
     _order_active = 0;
     _stack.clear();
+    _sync_stack_mirror(0);
 
     {
         tracer_proxy total;
@@ -155,16 +182,57 @@ tracer_proxy tracer::fork(std::string_view n, size_t interval)
         branch("interval")._epoch_if_required = last_fork;
         branch("sequence", _fence_active);
         branch("branches", _table.size());
+
+        // Published only on the fork right after stall, thus the node becomes obsolete
+        //  once the tracer runs normally again.
+        if (_has_stall_report.exchange(false, std::memory_order_acquire)) {
+            std::lock_guard _{_stall_report_lock};
+            branch("last-stall") = _stall_report;
+        }
     }
 
     tracer_proxy prx;
     prx._owner = this;
     prx._ref = _fork_branch(nullptr, n, false);
     prx._epoch_if_required = steady_clock::now();
+    _open_iteration(&prx);
 
     return prx;
 }
 
+void tracer::_open_iteration(tracer_proxy* root) noexcept
+{
+    root->_is_iteration_root = true;
+
+    std::lock_guard _{_iteration_lock};
+    ++_open_iterations;
+#if PERFKIT_STALL_CAPTURE
+    _working_thread_native = uint64_t(pthread_self());
+#endif
+}
+
+void tracer::_close_iteration() noexcept
+{
+    std::lock_guard _{_iteration_lock};
+    if (--_open_iterations == 0) { _working_thread_native = 0; }
+}
+
+void tracer::_sync_stack_mirror(size_t from) noexcept
+{
+    // Shrink visible range before rewriting entries, thus signal handler interrupting
+    //  this function never observes half-written range.
+    auto size = std::min(_stack.size(), std::size(_stack_mirror));
+    from = std::min(from, size);
+
+    _stack_mirror_size.store(int(from), std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_release);
+
+    std::copy(_stack.begin() + from, _stack.begin() + size, _stack_mirror + from);
+
+    std::atomic_signal_fence(std::memory_order_release);
+    _stack_mirror_size.store(int(size), std::memory_order_relaxed);
+}
+
 event<tracer*>& tracer::on_new_tracer()
 {
     constexpr auto ff = [] {};
@@ -179,6 +247,8 @@ bool tracer::_deliver_previous_result()
     if (on_fetch.empty())
         return false;
 
+    _analyze_timings();
+
     // copies all messages and put them to cache buffer to prevent memory reallocation
     // if any entity is folded, skip all of its subtree
     trace_fetch_proxy proxy{this};
@@ -188,6 +258,43 @@ bool tracer::_deliver_previous_result()
     return true;
 }
 
+void tracer::_analyze_timings()
+{
+    auto fence = _fence_active;
+    auto fn_timer = [](_entity_ty const& e) { return std::get_if<steady_clock::duration>(&e.body.data); };
+
+    for (auto& [_, entity] : _table) {
+        entity.children_time = {};
+        entity.heaviest_child = nullptr;
+        entity.body.on_critical_path = false;
+    }
+
+    // Accumulate children's inclusive time to their parents
+    for (auto& [_, entity] : _table) {
+        auto time = fn_timer(entity);
+        if (not time || entity.body.fence != fence || not entity.parent) { continue; }
+
+        auto parent = entity.parent;
+        parent->children_time += *time;
+
+        if (not parent->heaviest_child || *fn_timer(*parent->heaviest_child) < *time)
+            parent->heaviest_child = &entity;
+    }
+
+    for (auto& [_, entity] : _table) {
+        auto time = fn_timer(entity);
+        if (not time) { continue; }
+
+        entity.body.self_time = std::max(*time - entity.children_time, steady_clock::duration{});
+
+        // Critical path starts from every root timer of this iteration
+        if (entity.parent || entity.body.fence != fence) { continue; }
+
+        for (auto node = &entity; node; node = node->heaviest_child)
+            const_cast<_entity_ty*>(node)->body.on_critical_path = true;
+    }
+}
+
 void tracer::trace_fetch_proxy::fetch_tree(tracer::fetched_traces* out) const
 {
     out->clear();
@@ -246,12 +353,424 @@ void tracer::trace_fetch_proxy::fetch_tree_diff(tracer::fetched_traces* out, siz
     }
 }
 
+namespace _trace {
+static thread_local std::string _this_thread_name;
+
+class process_view
+{
+    struct node_stat {
+        // Latest value of each contributing thread
+        std::map<tracer const*, trace_variant_type> values;
+    };
+
+   private:
+    std::mutex _mtx;
+    tracer_ptr _tracer = tracer::create(INT_MAX, "[process]");
+    std::unordered_map<uint64_t, node_stat> _stats;
+
+    tracer::merge_mode _mode = tracer::merge_mode::sum;
+    double _percentile = 0.5;
+
+    // Reused buffers
+    std::vector<tracer::_entity_ty const*> _sorted;
+    std::vector<double> _samples;
+
+   public:
+    static process_view& get()
+    {
+        static process_view inst;
+        return inst;
+    }
+
+    void merge_mode(tracer::merge_mode mode, double percentile)
+    {
+        std::lock_guard _{_mtx};
+        _mode = mode;
+        _percentile = std::clamp(percentile, 0., 1.);
+    }
+
+    void merge(tracer* src, size_t fence)
+    {
+        std::lock_guard _{_mtx};
+        auto dst = _tracer.get();
+
+        // Same as fork(), but driven by whichever thread is flushing.
+        dst->_working_thread_id = std::this_thread::get_id();
+        if (dst->_fence_active > dst->_fence_latest)
+            dst->_deliver_previous_result();
+
+        ++dst->_fence_active;
+        dst->_order_active = 0;
+        dst->_stack.clear();
+        dst->_sync_stack_mirror(0);
+
+        // Collect nodes updated during given iteration. As parent node is always created
+        //  before its children, sorting by unique order guarantees parents come first.
+        _sorted.clear();
+        for (auto& [hash, entity] : src->_table)
+            if (entity.body.fence == fence && entity.hierarchy.front() != "[[summary]]")
+                _sorted.push_back(&entity);
+
+        std::sort(_sorted.begin(), _sorted.end(),
+                  [](auto a, auto b) { return a->body.unique_order < b->body.unique_order; });
+
+        for (auto entity : _sorted) {
+            tracer::_entity_ty const* parent = nullptr;
+
+            // Path hash doesn't depend on tracer, thus same path always yields same node.
+            if (entity->parent) {
+                auto iter = dst->_table.find(entity->parent->body.hash);
+                if (iter == dst->_table.end()) { continue; }
+                parent = &iter->second;
+            }
+
+            auto node = dst->_fork_branch(parent, entity->key_buffer, false);
+            auto& stat = _stats[node->body.hash];
+            stat.values[src] = entity->body.data;
+
+            _reduce(stat, entity->body.data, &node->body.data);
+        }
+
+        dst->_stack.clear();
+        dst->_sync_stack_mirror(0);
+    }
+
+    void remove(tracer const* src)
+    {
+        std::lock_guard _{_mtx};
+        for (auto& [_, stat] : _stats) { stat.values.erase(src); }
+    }
+
+   private:
+    void _reduce(node_stat const& stat, trace_variant_type const& latest, trace_variant_type* out)
+    {
+        auto index = latest.index();
+        if (index != 1 && index != 2 && index != 3) {
+            // Non-numeric values can't be merged. Latest value is used.
+            *out = latest;
+            return;
+        }
+
+        _samples.clear();
+        for (auto& [_, value] : stat.values) {
+            if (value.index() != index) { continue; }
+
+            if (auto p = std::get_if<steady_clock::duration>(&value))
+                _samples.push_back(double(p->count()));
+            else if (auto p = std::get_if<int64_t>(&value))
+                _samples.push_back(double(*p));
+            else
+                _samples.push_back(std::get<double>(value));
+        }
+
+        double result;
+        if (_mode == tracer::merge_mode::sum) {
+            result = std::accumulate(_samples.begin(), _samples.end(), 0.);
+        } else {
+            auto nth = _samples.begin() + size_t(_percentile * double(_samples.size() - 1) + 0.5);
+            std::nth_element(_samples.begin(), nth, _samples.end());
+            result = *nth;
+        }
+
+        if (index == 1)
+            *out = steady_clock::duration{steady_clock::duration::rep(result)};
+        else if (index == 2)
+            *out = int64_t(result);
+        else
+            *out = result;
+    }
+};
+}  // namespace _trace
+
+tracer_proxy tracer::fork_continuous(std::string_view n, steady_clock::duration flush_interval)
+{
+    auto now = steady_clock::now();
+
+    if (_fence_active == 0 || now - _last_flush >= flush_interval) {
+        // Flush accumulated iteration, then start new one.
+        if (_is_thread_local && _fence_active > 0)
+            _trace::process_view::get().merge(this, _fence_active);
+
+        _last_flush = now;
+
+        auto prx = fork(n);
+        _is_continuous = true;
+        return prx;
+    }
+
+    _is_continuous = true;
+
+    // Keep accumulating on current iteration.
+    _working_thread_id = std::this_thread::get_id();
+    _stack.clear();
+    _sync_stack_mirror(0);
+
+    tracer_proxy prx;
+    prx._owner = this;
+    prx._ref = _fork_branch(nullptr, n, false);
+    prx._epoch_if_required = now;
+    _open_iteration(&prx);
+
+    return prx;
+}
+
+namespace _trace {
+class stall_watchdog
+{
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    bool _stop = false;
+    std::thread _worker;
+
+#if PERFKIT_STALL_CAPTURE
+    enum capture_state : int {
+        capture_idle,
+        capture_requested,
+        capture_done,
+    };
+
+    struct capture_context {
+        std::atomic_int state = capture_idle;
+        tracer const* target = nullptr;
+
+        void* frames[64];
+        int num_frames = 0;
+
+        tracer::_entity_ty const* scopes[32];
+        size_t num_scopes = 0;
+    };
+
+    // Shared with signal handler. Only one capture can be in progress at once.
+    static inline capture_context _capture;
+
+    // Handler which was installed before ours. Signals not requested by watchdog go there.
+    static inline struct sigaction _prev_action = {};
+    std::once_flag _handler_installed;
+
+    static void _signal_handler(int sig, siginfo_t* info, void* uctx)
+    {
+        auto ctx = &_capture;
+        if (ctx->state.load(std::memory_order_acquire) != capture_requested) {
+            if (_prev_action.sa_flags & SA_SIGINFO) {
+                if (_prev_action.sa_sigaction) { _prev_action.sa_sigaction(sig, info, uctx); }
+            } else if (_prev_action.sa_handler != SIG_DFL && _prev_action.sa_handler != SIG_IGN) {
+                _prev_action.sa_handler(sig);
+            }
+
+            return;
+        }
+
+        ctx->num_frames = backtrace(ctx->frames, std::size(ctx->frames));
+
+        // _stack itself may be in the middle of reallocation. Read its mirror instead.
+        auto target = ctx->target;
+        auto num_scopes = size_t(target->_stack_mirror_size.load(std::memory_order_relaxed));
+        std::atomic_signal_fence(std::memory_order_acquire);
+
+        ctx->num_scopes = std::min(num_scopes, std::size(ctx->scopes));
+        std::copy_n(target->_stack_mirror, ctx->num_scopes, ctx->scopes);
+
+        ctx->state.store(capture_done, std::memory_order_release);
+    }
+
+    //! Signal is taken over only when a stall actually has to be captured.
+    static void _install_signal_handler()
+    {
+        // backtrace() may allocate on its first call, which is not allowed in signal handler.
+        void* dummy[1];
+        backtrace(dummy, 1);
+
+        struct sigaction action = {};
+        action.sa_sigaction = &stall_watchdog::_signal_handler;
+        action.sa_flags = SA_RESTART | SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(PERFKIT_STALL_SIGNAL, &action, &_prev_action);
+    }
+#endif
+
+   public:
+    static stall_watchdog& get()
+    {
+        static stall_watchdog inst;
+        return inst;
+    }
+
+    stall_watchdog()
+    {
+        _worker = std::thread{&stall_watchdog::_loop, this};
+    }
+
+    ~stall_watchdog()
+    {
+        {
+            std::lock_guard _{_mtx};
+            _stop = true;
+        }
+
+        _cv.notify_all();
+        _worker.join();
+    }
+
+   private:
+    void _loop()
+    {
+        std::unique_lock lc{_mtx};
+
+        while (not _stop) {
+            _cv.wait_for(lc, 100ms);
+            if (_stop) { break; }
+
+            lc.unlock();
+            for (auto& wp : *tracer::all_snapshot())
+                if (auto tr = wp.lock()) { _check(tr.get()); }
+            lc.lock();
+        }
+    }
+
+    void _check(tracer* tr)
+    {
+        auto deadline = steady_clock::duration{tr->_stall_deadline.load(std::memory_order_relaxed)};
+        if (deadline.count() <= 0) { return; }
+
+        auto last_fork = tr->_last_fork.load(std::memory_order_relaxed);
+        if (last_fork == steady_clock::time_point{}) { return; }  // Never forked yet
+
+        auto elapsed = steady_clock::now() - last_fork;
+        if (elapsed < deadline || tr->_stall_reported_fork == last_fork) { return; }
+
+        {
+            // Working thread already left the iteration, e.g. its loop ended normally.
+            std::lock_guard _{tr->_iteration_lock};
+            if (tr->_open_iterations == 0) { return; }
+        }
+
+        // Report only once per stall
+        tr->_stall_reported_fork = last_fork;
+
+        tracer_stall_info info;
+        info.elapsed = elapsed;
+        _capture_stack(tr, &info);
+
+        std::string report;
+        report += fmt::format("no fork for {:.3f} sec", std::chrono::duration<double>(elapsed).count());
+        if (not info.scope_path.empty())
+            report += fmt::format(", at '{}'", fmt::join(info.scope_path, "/"));
+
+        CPPH_WARN("tracer '{}' stalled: {}", tr->name(), report);
+        for (auto& frame : info.stack_trace)
+            CPPH_WARN("  {}", frame);
+
+        {
+            std::lock_guard _{tr->_stall_report_lock};
+            tr->_stall_report = std::move(report);
+        }
+
+        tr->_has_stall_report.store(true, std::memory_order_release);
+        tr->on_stall.invoke(info);
+    }
+
+    void _capture_stack(tracer* tr, tracer_stall_info* info)
+    {
+#if PERFKIT_STALL_CAPTURE
+        std::call_once(_handler_installed, &stall_watchdog::_install_signal_handler);
+
+        auto ctx = &_capture;
+        bool signalled = false;
+
+        {
+            // Working thread must close its iteration before exit, which is blocked while
+            //  the lock is held. Therefore the handle is guaranteed to be valid here.
+            std::lock_guard _{tr->_iteration_lock};
+            if (tr->_open_iterations == 0) { return; }
+
+            ctx->target = tr;
+            ctx->state.store(capture_requested, std::memory_order_release);
+
+            auto thread = pthread_t(tr->_working_thread_native);
+            signalled = pthread_kill(thread, PERFKIT_STALL_SIGNAL) == 0;
+        }
+
+        if (signalled) {
+            for (auto until = steady_clock::now() + 100ms; steady_clock::now() < until;) {
+                if (ctx->state.load(std::memory_order_acquire) == capture_done) { break; }
+                std::this_thread::sleep_for(1ms);
+            }
+        }
+
+        int expected = capture_requested;
+        if (ctx->state.compare_exchange_strong(expected, capture_idle)) {
+            CPPH_WARN("tracer '{}': failed to capture call stack of stalled thread", tr->name());
+            return;
+        }
+
+        for (auto scope : array_view{ctx->scopes, ctx->num_scopes})
+            info->scope_path.push_back(scope->key_buffer);
+
+        if (auto symbols = backtrace_symbols(ctx->frames, ctx->num_frames)) {
+            // Skip frames of signal handler itself
+            for (int i = 2; i < ctx->num_frames; ++i)
+                info->stack_trace.emplace_back(symbols[i]);
+
+            free(symbols);
+        }
+
+        ctx->state.store(capture_idle, std::memory_order_release);
+#endif
+    }
+};
+}  // namespace _trace
+
+void tracer::stall_deadline(steady_clock::duration deadline)
+{
+    _stall_deadline.store(deadline.count(), std::memory_order_relaxed);
+    if (deadline.count() > 0) { _trace::stall_watchdog::get(); }
+}
+
+tracer& tracer::this_thread()
+{
+    thread_local tracer_ptr inst = [] {
+        auto name = std::move(_trace::_this_thread_name);
+
+#if __linux__
+        if (name.empty()) {
+            char buf[32] = {};
+            if (pthread_getname_np(pthread_self(), buf, sizeof buf) == 0)
+                name = buf;
+        }
+#endif
+        if (name.empty()) {
+            static std::atomic_int _idgen = 0;
+            name = fmt::format("thread #{}", ++_idgen);
+        }
+
+        // Instantiate process view before any thread tracer, to make it outlive them.
+        _trace::process_view::get();
+
+        tracer_ptr ptr{new tracer{0, name}};
+        ptr->_is_thread_local = true;
+        return ptr;
+    }();
+
+    return *inst;
+}
+
+void tracer::this_thread_name(std::string_view name)
+{
+    _trace::_this_thread_name = name;
+}
+
+void tracer::process_view_merge_mode(merge_mode mode, double percentile)
+{
+    _trace::process_view::get().merge_mode(mode, percentile);
+}
+
 namespace {
 struct message_block_sorter {
     int n;
-    friend bool operator<(std::weak_ptr<tracer> ptr, message_block_sorter s)
+    friend bool operator<(std::weak_ptr<tracer> const& ptr, message_block_sorter s)
     {
-        return s.n < ptr.lock()->order();
+        auto lck = ptr.lock();
+        return lck && s.n < lck->order();
     }
 };
 }  // namespace
@@ -266,23 +785,30 @@ tracer::tracer(int order, std::string_view name) noexcept
 {
 }
 
-std::vector<std::weak_ptr<tracer>>& tracer::_all() noexcept
+auto tracer::_registry() noexcept -> registry_snapshot&
 {
-    static std::vector<std::weak_ptr<tracer>> inst;
+    // Only writers, which are serialized by lock_tracer_repo, replace the snapshot.
+    static registry_snapshot inst = std::make_shared<std::vector<std::weak_ptr<tracer>>>();
     return inst;
 }
 
+auto tracer::all_snapshot() noexcept -> registry_snapshot
+{
+    return std::atomic_load_explicit(&_registry(), std::memory_order_acquire);
+}
+
 std::vector<std::shared_ptr<tracer>> tracer::all() noexcept
 {
-    return lock_tracer_repo(),
-           [] {
-               std::vector<std::shared_ptr<tracer>> ret{};
-               ret.reserve(_all().size());
-               std::transform(
-                       _all().begin(), _all().end(), back_inserter(ret),
-                       [](auto&& p) { return p.lock(); });
-               return ret;
-           }();
+    auto snapshot = all_snapshot();
+
+    std::vector<std::shared_ptr<tracer>> ret{};
+    ret.reserve(snapshot->size());
+
+    for (auto& wp : *snapshot)
+        if (auto ptr = wp.lock())
+            ret.emplace_back(std::move(ptr));
+
+    return ret;
 }
 
 void tracer::request_fetch_data()
@@ -297,15 +823,24 @@ auto tracer::create(int order, std::string_view name) -> std::shared_ptr<tracer>
     std::shared_ptr<tracer> entity{
             new tracer{order, name}};
 
-    auto it_insert = std::lower_bound(_all().begin(), _all().end(), message_block_sorter{order});
+    auto next = std::make_shared<std::vector<std::weak_ptr<tracer>>>();
+    auto prev_snapshot = all_snapshot();
+    auto& prev = *prev_snapshot;
+    next->reserve(prev.size() + 1);
+
+    auto it_insert = std::lower_bound(prev.begin(), prev.end(), message_block_sorter{order});
 
-    if (it_insert != _all().end()) {
+    if (it_insert != prev.end()) {
         auto lck = it_insert->lock();
         if (lck && lck->name() == name)
             throw std::logic_error{"trace name duplicate!"};
     }
 
-    _all().insert(it_insert, entity);
+    next->assign(prev.begin(), it_insert);
+    next->emplace_back(entity);
+    next->insert(next->end(), it_insert, prev.end());
+
+    std::atomic_store_explicit(&_registry(), registry_snapshot{std::move(next)}, std::memory_order_release);
     on_new_tracer().invoke(&*entity);
 
     return entity;
@@ -318,15 +853,29 @@ void tracer::unregister()
 
     on_destroy.invoke(this);
 
+    if (_is_thread_local) {
+        // Thread tracers are not listed on global repository.
+        _trace::process_view::get().remove(this);
+        return;
+    }
+
     auto _{lock_tracer_repo()};
     CPPH_DEBUG("destroying tracer {}", _name);
-    auto it = std::find_if(_all().begin(), _all().end(),
+
+    auto prev_snapshot = all_snapshot();
+    auto& prev = *prev_snapshot;
+    auto it = std::find_if(prev.begin(), prev.end(),
                            [&](auto&& wptr) {
                                return perfkit::ptr_equals(wptr, weak_from_this());
                            });
 
-    if (it != _all().end()) {
-        _all().erase(it);
+    if (it != prev.end()) {
+        auto next = std::make_shared<std::vector<std::weak_ptr<tracer>>>();
+        next->reserve(prev.size());
+        next->assign(prev.begin(), it);
+        next->insert(next->end(), it + 1, prev.end());
+
+        std::atomic_store_explicit(&_registry(), registry_snapshot{std::move(next)}, std::memory_order_release);
         CPPH_DEBUG("erasing tracer from all {}", _name);
     } else {
         CPPH_DEBUG("logic error: tracer invalid! {}", _name);
@@ -351,6 +900,7 @@ void tracer::_try_pop(_trace::_entity_ty const* body)
 
     assert(i != ~size_t{});
     _stack.erase(_stack.begin() + i);
+    _sync_stack_mirror(i);
 }
 
 tracer_proxy tracer::timer(std::string_view name)
@@ -394,13 +944,26 @@ tracer_proxy::~tracer_proxy() noexcept
     if (!_owner) { return; }
     _owner->_try_pop(_ref);
 
+    if (_is_iteration_root) { _owner->_close_iteration(); }
+
     if (_epoch_if_required != steady_clock::time_point{}) {
-        _data() = steady_clock::now() - _epoch_if_required;
+        auto elapsed = steady_clock::now() - _epoch_if_required;
+        auto accumulated = std::get_if<steady_clock::duration>(&_data());
+        auto fence = _owner->_fence_active;
+
+        // On continuous mode, durations are accumulated until the iteration is flushed.
+        if (_owner->_is_continuous && accumulated && _ref->fence_accumulated == fence)
+            *accumulated += elapsed;
+        else
+            _data() = elapsed;
+
+        _ref->fence_accumulated = fence;
     }
 
     // clear to prevent logic error
     _owner = nullptr;
     _ref = nullptr;
+    _is_iteration_root = false;
 }
 
 tracer::variant_type& tracer::proxy::_data() noexcept
@@ -499,6 +1062,20 @@ void sort_messages_by_rule(tracer::fetched_traces& msg) noexcept
     std::sort(msg.begin(), msg.end(), compare_hierarchy_2);
 }
 
+void dump_folded_stacks(tracer::fetched_traces const& traces, std::string* out)
+{
+    out->clear();
+
+    for (auto& trace : traces) {
+        if (not trace.as_timer()) { continue; }
+
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(trace.self_time).count();
+        if (micros <= 0) { continue; }
+
+        fmt::format_to(std::back_inserter(*out), "{} {}\n", fmt::join(trace.hierarchy, ";"), micros);
+    }
+}
+
 void tracer::trace::dump_data(std::string& s) const
 {
     switch (data.index()) {
@@ -531,8 +1108,12 @@ void tracer::trace::dump_data(std::string& s) const
             s = std::get<bool>(data) ? "true" : "false";
             break;
 
-        case 6:                       // interactive_image_t;
-            s = "interactive_image";  // TODO
+        case 6:  // trace_array<double>,
+            s = fmt::format("[{:.4f}]", fmt::join(*std::get<trace_array<double>>(data), ", "));
+            break;
+
+        case 7:  // trace_array<int64_t>,
+            s = fmt::format("[{}]", fmt::join(*std::get<trace_array<int64_t>>(data), ", "));
             break;
 
         default:
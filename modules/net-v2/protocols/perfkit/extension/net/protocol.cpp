@@ -73,6 +73,11 @@ CPPH_REFL_DEFINE_OBJECT_c(
         config_entity_update_t, (),
         (config_key, 1), (content_next, 2));
 
+CPPH_REFL_DEFINE_OBJECT_c(
+        config_history_entry_t, (),
+        (fence, 1), (timestamp, 2), (config_key, 3), (source, 4),
+        (old_value, 11), (new_value, 12));
+
 CPPH_REFL_DEFINE_OBJECT_c(
         service::suggest_result_t, (),
         (replace_range, 1), (replaced_content, 2), (candidate_words, 3));
@@ -87,7 +92,8 @@ CPPH_REFL_DEFINE_OBJECT_c(
 
 CPPH_REFL_DEFINE_OBJECT_c(
         trace_update_t, (),
-        (index, 4), (fence_value, 1), (occurrence_order, 2), (flags, 3), (payload, 5));
+        (index, 4), (fence_value, 1), (occurrence_order, 2), (flags, 3), (payload, 5),
+        (self_time, 6), (on_critical_path, 7));
 
 CPPH_REFL_DEFINE_OBJECT_c(
         service::trace_control_t, (), (subscribe, 2), (fold, 3));
@@ -89,6 +89,21 @@ struct config_entity_update_t {
     msgpack_archive_t content_next;  // msgpack data chunk for supporting 'any'
 };
 
+/**
+ * Recorded config change. Values are msgpack encoded.
+ */
+struct config_history_entry_t {
+    CPPH_REFL_DECLARE_c;
+
+    uint64_t fence;
+    milliseconds timestamp;  // Since system clock epoch
+    uint64_t config_key;
+    string source;
+
+    msgpack_archive_t old_value;
+    msgpack_archive_t new_value;
+};
+
 enum class auth_level_t {
     unauthorized,
     basic_access,
@@ -107,7 +122,11 @@ struct tracer_descriptor_t {
     milliseconds epoch;
 };
 
-using trace_payload_t = std::variant<nullptr_t, steady_clock::duration, int64_t, double, string, bool>;
+// Array payloads are transferred as packed binary chunk of host-endian elements, instead of
+//  msgpack array of individually tagged numbers.
+using trace_payload_t = std::variant<
+        nullptr_t, steady_clock::duration, int64_t, double, string, bool,
+        binary<vector<double>>, binary<vector<int64_t>>>;
 
 struct trace_info_t {
     CPPH_REFL_DECLARE_c;
@@ -131,6 +150,10 @@ struct trace_update_t {
     bool flags[2];
     trace_payload_t payload;
 
+    // Timing analysis. Only meaningful for timer payloads.
+    steady_clock::duration self_time = {};
+    bool on_critical_path = false;
+
    public:
     auto& ref_subscr() { return flags[0]; }
     auto& ref_fold() { return flags[1]; }
@@ -180,6 +203,12 @@ struct notify {
      */
     DEFINE_RPC(config_entity_update, void(config_entity_update_t));
 
+    /**
+     * Configuration updates from this session, which were rejected by asynchronous
+     *  validation. Sent only to the session which requested the update.
+     */
+    DEFINE_RPC(config_entity_rejected, void(vector<uint64_t> config_keys));
+
     /**
      * Configuration class notifies
      */
@@ -297,6 +326,23 @@ struct service {
      */
     DEFINE_RPC(update_config_entity, void(config_entity_update_t));
 
+    /**
+     * Update multiple configs at once. Updates are grouped by owning registry, and each
+     *  group is either applied within the same update() or discarded as a whole.
+     */
+    DEFINE_RPC(update_config_entity_batch, void(vector<config_entity_update_t>));
+
+    /**
+     * Retrieve recorded changes of registry, oldest first.
+     */
+    DEFINE_RPC(config_history, vector<config_history_entry_t>(string registry_key));
+
+    /**
+     * Restore every config of registry changed after given fence, as single transaction.
+     *  Returns false if history doesn't cover the fence anymore.
+     */
+    DEFINE_RPC(config_rollback, bool(string registry_key, uint64_t fence));
+
     /**
      * Take graphics access authority.
      *
@@ -127,9 +127,9 @@ void config_context::rpc_republish_all_registries()
     });
 }
 
-void config_context::rpc_update_request(message::config_entity_update_t& content)
+void config_context::rpc_update_request(message::config_entity_update_t& content, weak_ptr<void> origin)
 {
-    post(*_ioc, [this, content] {
+    post(*_ioc, [this, content, origin = move(origin)] {
         auto elem = find_ptr(_inv_mapping, content.config_key);
         if (not elem) { return; }
 
@@ -141,11 +141,94 @@ void config_context::rpc_update_request(message::config_entity_update_t& content
 
         streambuf::view sbuf{{(char*)content.content_next.data(), content.content_next.size()}};
         archive::msgpack::reader reader{&sbuf};
-        owner->backend()->bk_commit(cfg.get(), &reader);
+        owner->backend()->bk_commit(cfg.get(), &reader, origin, "net");
         owner->backend()->bk_notify();
     });
 }
 
+void config_context::rpc_update_batch_request(vector<message::config_entity_update_t>& content)
+{
+    post(*_ioc, [this, content = move(content)] {
+        // Group updates by owning registry. Each registry commits as single transaction.
+        map<config_registry_ptr, config_transaction> transactions;
+
+        for (auto& update : content) {
+            auto elem = find_ptr(_inv_mapping, update.config_key);
+            if (not elem) { continue; }
+
+            auto cfg = elem->second.lock();
+            if (not cfg) { continue; }
+
+            auto owner = cfg->owner();
+            if (not owner) { continue; }
+
+            auto [iter, _] = transactions.try_emplace(owner, owner, "net");
+
+            streambuf::view sbuf{{(char*)update.content_next.data(), update.content_next.size()}};
+            archive::msgpack::reader reader{&sbuf};
+            iter->second.stage(cfg->id(), &reader);
+        }
+
+        for (auto& [rg, transaction] : transactions) {
+            if (not transaction.commit())
+                CPPH_WARN("Batch update to registry '{}' discarded", rg->name());
+
+            rg->backend()->bk_notify();
+        }
+    });
+}
+
+static config_registry_ptr find_registry(string_view name)
+{
+    vector<config_registry_ptr> registries;
+    config_registry::backend_t::bk_enumerate_registries(&registries);
+
+    for (auto& rg : registries)
+        if (rg->name() == name)
+            return rg;
+
+    return nullptr;
+}
+
+void config_context::rpc_history_request(string const& registry_key, vector<message::config_history_entry_t>* out)
+{
+    // Backend history is thread safe; no need to post to event procedure.
+    auto rg = find_registry(registry_key);
+    if (not rg) { return; }
+
+    vector<v2::config_history_entry> history;
+    rg->backend()->bk_history(&history);
+
+    out->resize(history.size());
+    for (size_t i = 0; i < history.size(); ++i) {
+        auto& src = history[i];
+        auto& dst = (*out)[i];
+
+        dst.fence = src.fence;
+        dst.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(src.timestamp.time_since_epoch());
+        dst.config_key = src.id.value;
+        dst.source = src.source;
+
+        auto old_value = src.old_value(), new_value = src.new_value();
+        dst.old_value.assign(old_value.begin(), old_value.end());
+        dst.new_value.assign(new_value.begin(), new_value.end());
+    }
+}
+
+bool config_context::rpc_rollback_request(string const& registry_key, uint64_t fence)
+{
+    auto rg = find_registry(registry_key);
+    if (not rg) { return false; }
+
+    if (not rg->backend()->bk_rollback(fence)) {
+        CPPH_WARN("Rollback of registry '{}' to fence {} failed", registry_key, fence);
+        return false;
+    }
+
+    rg->backend()->bk_notify();
+    return true;
+}
+
 void config_context::_init_registry_node(
         registry_table_type::iterator node, config_registry* ptr)
 {
@@ -165,10 +248,8 @@ void config_context::_init_registry_node(
             });
 
     ptr->backend()->evt_updated_entities.add_weak(
-            _monitor_anchor, [this](config_registry* rg, list<config_base_ptr> const& l) {
-                vector<config_base_ptr> updates;
-                updates.reserve(l.size());
-                updates.assign(l.begin(), l.end());
+            _monitor_anchor, [this](config_registry* rg, vector<config_base_ptr> const& l) {
+                vector<config_base_ptr> updates{l};  // Source buffer is reused by backend
 
                 post(*_ioc, bind_front_weak(_monitor_anchor,
                                             &config_context::_publish_updates,
@@ -176,6 +257,14 @@ void config_context::_init_registry_node(
                                             rg->shared_from_this(),
                                             move(updates)));
             });
+
+    ptr->backend()->evt_commit_rejected.add_weak(
+            _monitor_anchor, [this](config_registry*, vector<v2::config_commit_rejection> const& l) {
+                post(*_ioc, bind_front_weak(_monitor_anchor,
+                                            &config_context::_publish_rejections,
+                                            this,
+                                            l));
+            });
 }
 
 void config_context::_update_registry_structure(
@@ -204,7 +293,6 @@ void config_context::_update_registry_structure(
     // note: Sort order will be automatically applied by above routine.
 
     // Caches
-    string full_key;
     string display_key;
     vector<string_view> hierarchy_;
     streambuf::stringbuf msbuf;
@@ -225,11 +313,10 @@ void config_context::_update_registry_structure(
         if (cfg->attribute()->hidden)
             continue;
 
-        cfg->full_key(&full_key);
         _inv_mapping[cfg->id().value] = cfg;
 
-        // (1)
-        _configs::parse_full_key(full_key, &display_key, &hierarchy_);
+        // (1) Hierarchy refers to interned full key directly.
+        _configs::parse_full_key(cfg->full_key(), &display_key, &hierarchy_);
 
         array_view hierarchy = hierarchy_;
         hierarchy = hierarchy.subspan(0, hierarchy.size() - 1);
@@ -324,6 +411,23 @@ void config_context::_publish_updates(shared_ptr<config_registry> rg, vector<sha
     }
 }
 
+void config_context::_publish_rejections(vector<v2::config_commit_rejection> const& rejections)
+{
+    // Group rejections by originating session
+    map<weak_ptr<void>, vector<uint64_t>, std::owner_less<>> sessions;
+
+    for (auto& rejection : rejections)
+        sessions[rejection.origin].push_back(rejection.id.value);
+
+    for (auto& [origin, keys] : sessions) {
+        auto session = origin.lock();
+        if (not session) { continue; }
+
+        message::notify::config_entity_rejected(_rpc).notify(
+                keys, [&](rpc::session_profile const* profile) { return profile->user_data == session; });
+    }
+}
+
 void config_context::_publish_unregister(registry_table_type::iterator node)
 {
     message::notify::deleted_config_category(_rpc).notify(node->second.cat_root.name);
@@ -80,7 +80,10 @@ class config_context
 
    public:
     void rpc_republish_all_registries();
-    void rpc_update_request(message::config_entity_update_t& content);
+    void rpc_update_request(message::config_entity_update_t& content, weak_ptr<void> origin);
+    void rpc_update_batch_request(vector<message::config_entity_update_t>& content);
+    void rpc_history_request(string const& registry_key, vector<message::config_history_entry_t>* out);
+    bool rpc_rollback_request(string const& registry_key, uint64_t fence);
 
    private:
     void _init_registry_node(registry_table_type::iterator, config_registry* ptr);
@@ -88,6 +91,7 @@ class config_context
     void _publish_registry_refresh(registry_table_type::iterator const& node);
     void _publish_unregister(registry_table_type::iterator node);
     void _publish_updates(shared_ptr<config_registry>, vector<shared_ptr<config_base>> const& update_list);
+    void _publish_rejections(vector<v2::config_commit_rejection> const& rejections);
     void _gc_mappings();
 };
 }  // namespace perfkit::net
@@ -36,6 +36,47 @@
 #include "perfkit/detail/tracer.hpp"
 #include "range/v3/view/map.hpp"
 
+namespace perfkit::net {
+template <typename Elem>
+static void assign_array_payload(message::trace_payload_t* dst, vector<Elem> const& src, vector<vector<Elem>>* spares)
+{
+    auto& array = dst->emplace<binary<vector<Elem>>>().ref();
+    if (not spares->empty()) {
+        swap(array, spares->back());
+        spares->pop_back();
+    }
+
+    array.assign(src.begin(), src.end());
+}
+
+static void assign_payload(
+        message::trace_payload_t* dst, trace_variant_type const& src,
+        vector<vector<double>>* spare_f64, vector<vector<int64_t>>* spare_i64)
+{
+    std::visit(
+            [&](auto const& value) {
+                using value_type = std::decay_t<decltype(value)>;
+
+                if constexpr (std::is_same_v<value_type, trace_array<double>>) {
+                    assign_array_payload(dst, *value, spare_f64);
+                } else if constexpr (std::is_same_v<value_type, trace_array<int64_t>>) {
+                    assign_array_payload(dst, *value, spare_i64);
+                } else {
+                    *dst = value;
+                }
+            },
+            src);
+}
+
+template <typename Elem>
+static void retrieve_array_payload(message::trace_payload_t* src, vector<vector<Elem>>* spares)
+{
+    if (auto array = std::get_if<binary<vector<Elem>>>(src)) {
+        spares->emplace_back(move(array->ref()));
+    }
+}
+}  // namespace perfkit::net
+
 void perfkit::net::trace_context::build_service(perfkit::rpc::service_builder& target)
 {
     target.route(message::service::trace_request_control, bind_front(&self_type::_rpc_request_control, this));
@@ -202,6 +243,12 @@ void perfkit::net::trace_context::_on_fetch(
     auto info = winfo.lock();
     if (not info) { return; }
 
+    // Keep array buffers of previous publish, to avoid reallocation on every fetch.
+    for (auto& update : _buf_updates) {
+        retrieve_array_payload(&update.payload, &_spare_f64);
+        retrieve_array_payload(&update.payload, &_spare_i64);
+    }
+
     _buf_updates.clear();
     _buf_info.clear();
 
@@ -228,7 +275,9 @@ void perfkit::net::trace_context::_on_fetch(
                 m->fence_value = e.fence;
                 m->ref_subscr() = e.subscribing();
                 m->ref_fold() = e.folded();
-                m->payload = e.data;
+                m->self_time = e.self_time;
+                m->on_critical_path = e.on_critical_path;
+                assign_payload(&m->payload, e.data, &_spare_f64, &_spare_i64);
             };
 
     for (auto& entity : *pbuf) {
@@ -80,6 +80,10 @@ class trace_context
     vector<message::trace_update_t> _buf_updates;
     vector<message::trace_info_t> _buf_info;
 
+    // Array payload buffers of previously published updates, reused on next publish.
+    vector<vector<double>> _spare_f64;
+    vector<vector<int64_t>> _spare_i64;
+
    public:
     explicit trace_context(if_net_terminal_adapter* host) : _host(host) {}
 
@@ -237,7 +237,22 @@ auto perfkit::net::terminal::_build_service() -> rpc::service
             .route(service::update_config_entity,
                    [this](auto&& prof, auto&&, auto&& content) {
                        _verify_admin_access(prof);
-                       _ctx_config.rpc_update_request(content);
+                       _ctx_config.rpc_update_request(content, prof->user_data);
+                   })
+            .route(service::update_config_entity_batch,
+                   [this](auto&& prof, auto&&, auto&& content) {
+                       _verify_admin_access(prof);
+                       _ctx_config.rpc_update_batch_request(content);
+                   })
+            .route(service::config_history,
+                   [this](auto&& prof, auto* out, auto&& registry_key) {
+                       _verify_basic_access(prof);
+                       _ctx_config.rpc_history_request(registry_key, out);
+                   })
+            .route(service::config_rollback,
+                   [this](auto&& prof, auto* out, auto&& registry_key, auto&& fence) {
+                       _verify_admin_access(prof);
+                       *out = _ctx_config.rpc_rollback_request(registry_key, fence);
                    })
             .route(service::request_republish_registries,
                    [this](auto&& prof, auto&&) {
@@ -327,8 +327,9 @@ export default function ConfigPanel(props: { socketUrl: string }) {
   }
 
   function commitAllChanges() {
+    // Changes of same root are applied all at once, or discarded all together.
     const commit = {
-      method: 'commit',
+      method: 'commit-batch',
       params: [] as any[]
     };
 
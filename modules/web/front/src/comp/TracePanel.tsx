@@ -71,10 +71,18 @@ interface TracerNodeValue_P extends TracerNodeValueBase {
 
 interface TracerNodeValue_T extends TracerNodeValueBase {
   T: "T";
-  V: number
+  V: number;
+  S: number; // Self time, excluding children's time
+  C: boolean; // Is on critical path of latest iteration
 }
 
-type TracerNodeValue = TracerNodeValue_P | TracerNodeValue_T;
+interface TracerNodeValue_A extends TracerNodeValueBase {
+  T: "A";
+  E: "f64" | "i64"; // Element type
+  V: string // Base64 encoded packed array
+}
+
+type TracerNodeValue = TracerNodeValue_P | TracerNodeValue_T | TracerNodeValue_A;
 const TraceSocketContext = createContext(null as any as WebSocket);
 
 export default function TracePanel(prop: { socketUrl: string }) {
@@ -357,8 +365,13 @@ function TraceNode(props: { root: TracerContext, context: TracerNodeContext }) {
       </div>
       <span style={{color: typeColor}} ref={frameRef} className={'px-2'}>{
         context.body.T === "T"
-          ? <span>{(context.body.V * 1e3).toFixed(3)} <span className='text-secondary small'> ms</span></span>
-          : stringify(context.body.V)
+          ? <span className={context.body.C ? 'fw-bold' : ''}>
+            {(context.body.V * 1e3).toFixed(3)} <span className='text-secondary small'> ms</span>
+            <span className='text-secondary small ms-2'>(self {(context.body.S * 1e3).toFixed(3)} ms)</span>
+          </span>
+          : context.body.T === "A"
+            ? stringify(unpackArray(context.body))
+            : stringify(context.body.V)
       }</span>
     </div>;
   }
@@ -396,6 +409,13 @@ function TraceNode(props: { root: TracerContext, context: TracerNodeContext }) {
   </span>
 }
 
+function unpackArray(value: TracerNodeValue_A): number[] {
+  const raw = Uint8Array.from(atob(value.V), c => c.charCodeAt(0));
+  return value.E === "f64"
+    ? Array.from(new Float64Array(raw.buffer))
+    : Array.from(new BigInt64Array(raw.buffer), v => Number(v));
+}
+
 function stringify(value: any) {
   return typeof value === "string" ? value : JSON.stringify(value);
 }
@@ -39,6 +39,7 @@
 #include <cpph/container/alloca_fwd_list.hxx>
 #include <cpph/refl/archive/json-reader.hxx>
 #include <cpph/refl/archive/json-writer.hxx>
+#include <cpph/refl/archive/msgpack-reader.hxx>
 #include <cpph/refl/object.hxx>
 #include <cpph/refl/types/list.hxx>
 #include <cpph/refl/types/tuple.hxx>
@@ -203,8 +204,8 @@ class config_server_impl : public config_server
 
         rg->backend()->evt_updated_entities()
                 << anchor_
-                << [this, wp = weak_ptr{rg}](config_registry* rg, list<config_base_ptr> updates) {
-                       ioc_.post([this, wp, updates = move(updates), wrg = rg->weak_from_this()] {
+                << [this, wp = weak_ptr{rg}](config_registry* rg, vector<config_base_ptr> const& updates) {
+                       ioc_.post([this, wp, updates, wrg = rg->weak_from_this()] {
                            auto rg = wrg.lock();
                            if (not rg || clients_.empty())
                                return;
@@ -234,6 +235,26 @@ class config_server_impl : public config_server
                        });
                    };
 
+        rg->backend()->evt_commit_rejected()
+                << anchor_
+                << [this](config_registry* rg, vector<config_commit_rejection> const& rejections) {
+                       ioc_.post([this, rejections, root_name = rg->name()] {
+                           // Report back to each client which requested the update
+                           map<weak_ptr<void>, list<pair<string, uint64_t>>, std::owner_less<>> discarded;
+                           for (auto& rejection : rejections)
+                               discarded[rejection.origin].emplace_back(root_name, rejection.id.value);
+
+                           for (auto& [origin, items] : discarded) {
+                               auto conn = static_pointer_cast<if_websocket_session>(origin.lock());
+                               if (not conn) { continue; }
+
+                               auto wr = ioc_writer_prepare_("discarded");
+                               *wr << items;
+                               conn->send_text(*ioc_writer_done_());
+                           }
+                       });
+                   };
+
         // GC Client first.
         erase_if(clients_, [](auto&& e) { return e.expired(); });
 
@@ -294,9 +315,9 @@ class config_server_impl : public config_server
 
     void ioc_generate_descriptor_(config_registry* rg, config_base* cfg, archive::if_writer* wr)
     {
-        string full_key = cfg->full_key(), display_key;
+        string display_key;
         vector<string_view> hierarchy;
-        _configs::parse_full_key(full_key, &display_key, &hierarchy);
+        _configs::parse_full_key(cfg->full_key(), &display_key, &hierarchy);
         hierarchy.pop_back();  // Exclude its name() element.
 
         // Generate 'ElemDesc'
@@ -364,7 +385,13 @@ class config_server_impl : public config_server
 
                 if (json_rd_.goto_key("params")) {
                     if (method_name == "commit")
-                        ioc_handle_upload_params_(move(ws), json_rd_);
+                        ioc_handle_upload_params_(move(ws), json_rd_, false);
+                    else if (method_name == "commit-batch")
+                        ioc_handle_upload_params_(move(ws), json_rd_, true);
+                    else if (method_name == "history")
+                        ioc_handle_history_(move(ws), json_rd_);
+                    else if (method_name == "rollback")
+                        ioc_handle_rollback_(move(ws), json_rd_);
                 } else {
                     throw std::runtime_error{"Missing 'params'"};
                 }
@@ -376,12 +403,98 @@ class config_server_impl : public config_server
         }
     }
 
-    void ioc_handle_upload_params_(weak_ptr<if_websocket_session> ws, archive::json::reader& rd)
+    void ioc_handle_history_(weak_ptr<if_websocket_session> ws, archive::json::reader& rd)
+    {
+        auto exit_key = rd.begin_array();
+        auto root_name = rd.read_as<string>();
+        rd.end_array(exit_key);
+
+        auto conn = ws.lock();
+        auto p_pair = find_ptr(regs_strmap_, root_name);
+        auto rg = p_pair ? p_pair->second.lock() : nullptr;
+        if (not conn || not rg) { return; }
+
+        auto backend = rg->backend();
+        vector<config_history_entry> history;
+        backend->bk_history(&history);
+
+        // Recorded values are msgpack encoded; decode them with type of each config.
+        auto fn_write_value = [&](auto&& wr, config_base* cfg, string_view msgpack) {
+            if (cfg) {
+                try {
+                    auto object = cfg->attribute()->fn_construct();
+                    streambuf::const_view sbuf{{msgpack.data(), msgpack.size()}};
+                    archive::msgpack::reader reader{&sbuf};
+                    reader >> object.view();
+
+                    *wr << object.view();
+                    return;
+                } catch (std::exception&) {
+                    // Fallthrough
+                }
+            }
+
+            *wr << nullptr;
+        };
+
+        auto wr = ioc_writer_prepare_("history");
+        *wr << push_object(2);
+        *wr << key << "rootName" << rg->name();
+        *wr << key << "entries" << push_array(history.size());
+
+        for (auto& entry : history) {
+            auto cfg = backend->bk_find(entry.id);
+            auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(entry.timestamp.time_since_epoch());
+
+            *wr << push_object(6);
+            *wr << key << "fence" << entry.fence;
+            *wr << key << "timestamp" << timestamp.count();
+            *wr << key << "configKey" << entry.id.value;
+            *wr << key << "source" << entry.source;
+            *wr << key << "oldValue";
+            fn_write_value(wr, cfg.get(), entry.old_value());
+            *wr << key << "newValue";
+            fn_write_value(wr, cfg.get(), entry.new_value());
+            *wr << pop_object;
+        }
+
+        *wr << pop_array;
+        *wr << pop_object;
+
+        conn->send_text(*ioc_writer_done_());
+    }
+
+    void ioc_handle_rollback_(weak_ptr<if_websocket_session> ws, archive::json::reader& rd)
+    {
+        auto exit_key = rd.begin_array();
+        auto root_name = rd.read_as<string>();
+        auto fence = rd.read_as<uint64_t>();
+        rd.end_array(exit_key);
+
+        bool succeeded = false;
+        if (auto p_pair = find_ptr(regs_strmap_, root_name)) {
+            if (auto rg = p_pair->second.lock()) {
+                succeeded = rg->backend()->bk_rollback(fence);
+                rg->backend()->bk_notify();
+            }
+        }
+
+        if (auto conn = ws.lock()) {
+            auto wr = ioc_writer_prepare_("rollback");
+            *wr << push_array(3) << root_name << fence << succeeded << pop_array;
+            conn->send_text(*ioc_writer_done_());
+        }
+    }
+
+    void ioc_handle_upload_params_(weak_ptr<if_websocket_session> ws, archive::json::reader& rd, bool is_batch)
     {
         auto exit_key = rd.begin_array();
         set<shared_ptr<config_registry>> notify_targets_;
         list<pair<string, uint64_t>> discarded;
 
+        // On batch commit, updates are committed as single transaction per registry.
+        map<shared_ptr<config_registry>, pair<config_transaction, list<uint64_t>>> transactions;
+
         string root_name;
         for (auto _ : counter(rd.elem_left())) {
             auto exit_key_2 = rd.begin_array();
@@ -392,7 +505,12 @@ class config_server_impl : public config_server
             if (auto p_pair = find_ptr(regs_strmap_, root_name)) {
                 if (auto rg = p_pair->second.lock()) {
                     notify_targets_.emplace(rg);
-                    if (not rg->backend()->bk_commit({id}, &rd)) {
+
+                    if (is_batch) {
+                        auto& [transaction, ids] = transactions.try_emplace(rg, rg->transaction("web"), list<uint64_t>{}).first->second;
+                        transaction.stage({id}, &rd);
+                        ids.push_back(id);
+                    } else if (not rg->backend()->bk_commit({id}, &rd, ws, "web")) {
                         discarded.emplace_back(root_name, id);
                     }
                 }
@@ -402,6 +520,14 @@ class config_server_impl : public config_server
         }
         rd.end_array(exit_key);
 
+        for (auto& [rg, entry] : transactions) {
+            auto& [transaction, ids] = entry;
+            if (transaction.commit()) { continue; }
+
+            for (auto id : ids)
+                discarded.emplace_back(rg->name(), id);
+        }
+
         for (auto& rg : notify_targets_) {
             rg->backend()->bk_notify();
         }
@@ -305,8 +305,10 @@ class trace_server_impl : public trace_server
                 for (auto idx : idx_updated_node) {
                     auto& trace = (*traces)[idx];
 
+                    auto const n_keys = 4 + (trace.data.index() >= 6 ? 1 : 0) + (trace.data.index() == 1 ? 2 : 0);
+
                     *wr << push_array(2) << idx;
-                    *wr << push_object(4);
+                    *wr << push_object(n_keys);
                     {
                         *wr << key << "f_F" << trace.folded();
                         *wr << key << "f_S" << trace.subscribing();
@@ -318,6 +320,8 @@ class trace_server_impl : public trace_server
                                 break;
                             case 1:  // duration
                                 *wr << "T" << key << "V" << to_seconds(get<steady_clock::duration>(trace.data));
+                                *wr << key << "S" << to_seconds(trace.self_time);
+                                *wr << key << "C" << trace.on_critical_path;
                                 break;
                             case 2:  // integer
                                 *wr << "P" << key << "V" << get<int64_t>(trace.data);
@@ -336,6 +340,14 @@ class trace_server_impl : public trace_server
                             case 5:  // boolean
                                 *wr << "P" << key << "V" << get<bool>(trace.data);
                                 break;
+                            case 6:  // array of double
+                                *wr << "A" << key << "E" << "f64" << key << "V";
+                                write_packed_(wr, *get<trace_array<double>>(trace.data));
+                                break;
+                            case 7:  // array of integer
+                                *wr << "A" << key << "E" << "i64" << key << "V";
+                                write_packed_(wr, *get<trace_array<int64_t>>(trace.data));
+                                break;
                             default:
                                 CPPH_WARN("INVALID VARIANT INDEX!!!");
                                 *wr << "P" << key << "V" << nullptr;
@@ -355,6 +367,17 @@ class trace_server_impl : public trace_server
         tc->waiting_sessions_.clear();
     }
 
+    template <typename Elem>
+    static void write_packed_(archive::if_writer* wr, vector<Elem> const& array)
+    {
+        // Array values are sent as packed binary(base64 on json), which is far smaller and
+        //  cheaper to generate than json array of numbers.
+        auto n_bytes = array.size() * sizeof(Elem);
+        wr->binary_push(n_bytes);
+        wr->binary_write_some({reinterpret_cast<char const*>(array.data()), n_bytes});
+        wr->binary_pop();
+    }
+
     archive::if_writer* ioc_writer_prepare_(string_view method)
     {
         sbuf_.clear(), json_wr_.clear();